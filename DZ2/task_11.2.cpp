@@ -2,6 +2,9 @@
 #include <iomanip>
 #include <vector>
 #include <cmath>
+#include <cstdlib>
+#include <string>
+#include "../realtime_pacer.h"
 
 // 1. Класс Engine (двигательная установка)
 class Engine {
@@ -91,14 +94,23 @@ private:
     Engine engine;
     Navigation nav;
     double time;
+    bool paced;                   // шаги шли в темпе реального времени
+    RealTimePacer pacer;          // дедлайны и задержки шагов
 
 public:
     // Конструктор
-    AutonomousFlightSystem(const Engine& e, const Navigation& n) : engine(e), nav(n), time(0) {}
+    AutonomousFlightSystem(const Engine& e, const Navigation& n)
+        : engine(e), nav(n), time(0), paced(false) {}
+
+    // Выполняет пошаговую симуляцию.
+    // realTimeRate > 0: шаг dt занимает dt / realTimeRate секунд реального времени
+    void simulate(double dt, double totalTime, double realTimeRate = 0.0) {
+        paced = realTimeRate > 0;
+        if (paced) pacer.start(dt, realTimeRate);   // сбрасывает статистику прошлого запуска
 
-    // Выполняет пошаговую симуляцию
-    void simulate(double dt, double totalTime) {
         while (time < totalTime && engine.hasFuel()) {
+            if (paced) pacer.beginStep();
+
             // Обновляем двигатель
             engine.burn(dt);
             
@@ -110,6 +122,9 @@ public:
             
             // Увеличиваем время
             time += dt;
+
+            // Ждем дедлайна шага; вывод статуса входит в измеренное время
+            if (paced) pacer.endStep();
         }
     }
 
@@ -119,10 +134,28 @@ public:
         std::cout << std::fixed << std::setprecision(2);
         std::cout << "Максимальная высота: " << nav.getAltitude() << " м" << std::endl;
         std::cout << "Оставшееся топливо: " << engine.getFuel() << " кг" << std::endl;
+        if (paced) {
+            pacer.printReport();
+        }
     }
 };
 
-int main() {
+// --realtime <rate>: шаг dt занимает dt / rate секунд реального времени
+int main(int argc, char* argv[]) {
+    double realTimeRate = 0.0;
+    for (int i = 1; i < argc; i++) {
+        if (std::string(argv[i]) == "--realtime" && i + 1 < argc) {
+            const char* text = argv[++i];
+            char* end = nullptr;
+            realTimeRate = std::strtod(text, &end);
+            if (end == text || *end != '\0' || !std::isfinite(realTimeRate) || realTimeRate <= 0) {
+                std::cerr << "Ошибка: --realtime ожидает положительное число, получено '"
+                    << text << "'" << std::endl;
+                return 1;
+            }
+        }
+    }
+
     // Создаем двигатель: тяга 50000 Н, расход 20 кг/с, топливо 100 кг
     Engine engine(50000, 20, 100);
     
@@ -133,7 +166,7 @@ int main() {
     AutonomousFlightSystem system(engine, navigation);
     
     // Запускаем симуляцию: шаг 1.0 с, общее время 10 с
-    system.simulate(1.0, 10.0);
+    system.simulate(1.0, 10.0, realTimeRate);
     
     // Выводим итоги
     system.printSummary();
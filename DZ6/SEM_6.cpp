@@ -1,568 +1,4444 @@
-﻿#include <iostream>
-#include <fstream>
-#include <vector>
-#include <cmath>
-#include <string>
-#include <map>
-#include <algorithm>
-#include <sstream>
-#include <numeric>
-
-class TrajectoryLogger {
-private:
-    struct Point {
-        double x, y, z, speed, time;
-    };
-    std::vector<Point> points;
-    std::string filename;
-
-public:
-    TrajectoryLogger(const std::string& fname) : filename(fname) {}
-
-    void addPoint(double x, double y, double z, double speed, double time) {
-        points.push_back({ x, y, z, speed, time });
-    }
-
-    bool saveToCSV() {
-        std::ofstream file(filename);
-        if (!file.is_open()) return false;
-        file << "time,x,y,z,speed\n";
-        for (const auto& p : points) {
-            file << p.time << "," << p.x << "," << p.y << "," << p.z << "," << p.speed << "\n";
-        }
-        file.close();
-        return true;
-    }
-
-    bool loadFromCSV() {
-        std::ifstream file(filename);
-        if (!file.is_open()) return false;
-        std::string header;
-        std::getline(file, header);
-        double t, x, y, z, s;
-        char comma;
-        points.clear();
-        while (file >> t >> comma >> x >> comma >> y >> comma >> z >> comma >> s) {
-            points.push_back({ x, y, z, s, t });
-        }
-        file.close();
-        return true;
-    }
-
-    double calculateTotalDistance() {
-        double dist = 0.0;
-        for (size_t i = 1; i < points.size(); i++) {
-            double dx = points[i].x - points[i - 1].x;
-            double dy = points[i].y - points[i - 1].y;
-            double dz = points[i].z - points[i - 1].z;
-            dist += sqrt(dx * dx + dy * dy + dz * dz);
-        }
-        return dist;
-    }
-
-    double findMaxSpeed() {
-        double maxSpeed = 0.0;
-        for (const auto& p : points) {
-            if (p.speed > maxSpeed) maxSpeed = p.speed;
-        }
-        return maxSpeed;
-    }
-
-    void printStatistics() {
-        std::cout << "Total points: " << points.size() << "\n";
-        std::cout << "Total distance: " << calculateTotalDistance() << "\n";
-        std::cout << "Max speed: " << findMaxSpeed() << "\n";
-    }
-};
-
-class TargetManager {
-private:
-    struct Target {
-        int id;
-        std::string name;
-        double x, y, z, priority, distance;
-    };
-    std::vector<Target> targets;
-    std::string filename = "targets.bd";
-
-public:
-    void addTarget(int id, const std::string& name, double x, double y, double z,
-        double priority, double distance) {
-        targets.push_back({ id, name, x, y, z, priority, distance });
-    }
-
-    bool removeTarget(int target_id) {
-        auto it = std::remove_if(targets.begin(), targets.end(),
-            [target_id](const Target& t) { return t.id == target_id; });
-        if (it != targets.end()) {
-            targets.erase(it, targets.end());
-            return true;
-        }
-        return false;
-    }
-
-    void saveTargetsToFile() {
-        std::ofstream file(filename);
-        for (const auto& t : targets) {
-            file << t.id << "," << t.name << "," << t.x << "," << t.y << "," << t.z << ","
-                << t.priority << "," << t.distance << "\n";
-        }
-        file.close();
-    }
-
-    void loadTargetsFromFile() {
-        std::ifstream file(filename);
-        targets.clear();
-        int id;
-        std::string name;
-        double x, y, z, pr, dist;
-        char comma;
-        while (file >> id >> comma && std::getline(file, name, ',') &&
-            file >> x >> comma >> y >> comma >> z >> comma >> pr >> comma >> dist) {
-            targets.push_back({ id, name, x, y, z, pr, dist });
-        }
-        file.close();
-    }
-
-    std::vector<Target> getHighPriorityTargets(double min_priority) {
-        std::vector<Target> high;
-        std::copy_if(targets.begin(), targets.end(), std::back_inserter(high),
-            [min_priority](const Target& t) { return t.priority >= min_priority; });
-        return high;
-    }
-
-    void sortByDistance() {
-        std::sort(targets.begin(), targets.end(),
-            [](const Target& a, const Target& b) { return a.distance < b.distance; });
-    }
-};
-
-struct TelemetryData {
-    double time, altitude, speed, heading, fuel;
-};
-
-class TelemetryLogger {
-private:
-    std::string baseFilename = "telemetry";
-    int fileCounter = 1;
-    const size_t maxEntries = 1000;
-    std::vector<TelemetryData> buffer;
-
-public:
-    bool logData(double time, double altitude, double speed, double heading, double fuel) {
-        buffer.push_back({ time, altitude, speed, heading, fuel });
-        if (buffer.size() >= maxEntries) {
-            rotateFileIfNeeded();
-        }
-        return true;
-    }
-
-    void rotateFileIfNeeded() {
-        if (buffer.empty()) return;
-        std::string filename = baseFilename + "_" + std::to_string(fileCounter++) + ".bin";
-        std::ofstream file(filename, std::ios::binary);
-        file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size() * sizeof(TelemetryData));
-        file.close();
-        buffer.clear();
-    }
-
-    std::vector<TelemetryData> readLogFile(const std::string& filename) {
-        std::ifstream file(filename, std::ios::binary);
-        if (!file.is_open()) return {};
-        file.seekg(0, std::ios::end);
-        size_t size = file.tellg();
-        file.seekg(0, std::ios::beg);
-        size_t count = size / sizeof(TelemetryData);
-        std::vector<TelemetryData> data(count);
-        file.read(reinterpret_cast<char*>(data.data()), size);
-        file.close();
-        return data;
-    }
-
-    void printLogSummary() {
-        double totalTime = 0, avgAlt = 0, avgSpeed = 0;
-        for (const auto& d : buffer) {
-            totalTime += d.time;
-            avgAlt += d.altitude;
-            avgSpeed += d.speed;
-        }
-        std::cout << "Entries: " << buffer.size() << "\n";
-        std::cout << "Avg Altitude: " << avgAlt / buffer.size() << "\n";
-        std::cout << "Avg Speed: " << avgSpeed / buffer.size() << "\n";
-    }
-};
-
-struct Waypoint {
-    int id;
-    double x, y, z, speed;
-    std::string desc;
-};
-
-class WaypointManager {
-private:
-    std::vector<Waypoint> waypoints;
-    int currentIndex = 0;
-
-public:
-    void addWaypoint(int id, double x, double y, double z, double speed, const std::string& desc) {
-        waypoints.push_back({ id, x, y, z, speed, desc });
-    }
-
-    bool saveRoute() {
-        std::ofstream file("waypoints.bd");
-        for (const auto& w : waypoints) {
-            file << w.id << "," << w.x << "," << w.y << "," << w.z << "," << w.speed << "," << w.desc << "\n";
-        }
-        file.close();
-        return true;
-    }
-
-    bool loadRoute() {
-        std::ifstream file("waypoints.bd");
-        waypoints.clear();
-        int id;
-        double x, y, z, speed;
-        std::string desc;
-        char comma;
-        while (file >> id >> comma >> x >> comma >> y >> comma >> z >> comma >> speed >> comma && std::getline(file, desc)) {
-            waypoints.push_back({ id, x, y, z, speed, desc });
-        }
-        file.close();
-        return !waypoints.empty();
-    }
-
-    double calculateTotalDistance() {
-        double dist = 0.0;
-        for (size_t i = 1; i < waypoints.size(); i++) {
-            double dx = waypoints[i].x - waypoints[i - 1].x;
-            double dy = waypoints[i].y - waypoints[i - 1].y;
-            double dz = waypoints[i].z - waypoints[i - 1].z;
-            dist += sqrt(dx * dx + dy * dy + dz * dz);
-        }
-        return dist;
-    }
-
-    Waypoint getNextWaypoint() {
-        if (currentIndex < waypoints.size()) return waypoints[currentIndex];
-        return {};
-    }
-
-    bool checkWaypointReached(double x, double y, double z) {
-        if (currentIndex >= waypoints.size()) return false;
-        auto& w = waypoints[currentIndex];
-        double dist = sqrt(pow(x - w.x, 2) + pow(y - w.y, 2) + pow(z - w.z, 2));
-        if (dist < 10.0) { // tolerance
-            currentIndex++;
-            return true;
-        }
-        return false;
-    }
-};
-
-class DataValidator {
-private:
-    struct Rule {
-        double min, max;
-    };
-    std::map<std::string, Rule> rules;
-    std::vector<std::string> errors;
-
-public:
-    void addValidationRule(const std::string& field, double min, double max) {
-        rules[field] = { min, max };
-    }
-
-    bool validateCoordinates(double x, double y, double z) {
-        bool valid = true;
-        if (rules.count("x") && (x < rules["x"].min || x > rules["x"].max)) {
-            errors.push_back("Координата x вне диапазона");
-            valid = false;
-        }
-        if (rules.count("z") && z > 5000) {
-            errors.push_back("Высота z превышает максимум 5000");
-            valid = false;
-        }
-        return valid;
-    }
-
-    bool validateSpeed(double speed) {
-        if (rules.count("speed") && speed > 300) {
-            errors.push_back("Скорость превышает максимум 300");
-            return false;
-        }
-        return true;
-    }
-
-    bool validateAcceleration(double acceleration) {
-        if (rules.count("acceleration") && acceleration > 20) {
-            errors.push_back("Ускорение превышает максимум 20");
-            return false;
-        }
-        return true;
-    }
-
-    void generateValidationReport() {
-        std::ofstream file("validation_report.txt");
-        file << "Отчет валидации:\n";
-        for (const auto& err : errors) {
-            file << err << "\n";
-        }
-        file << "Общий результат: " << getValidationScore() * 100 << "% данных валидны\n";
-        file.close();
-    }
-
-    double getValidationScore() {
-        return errors.empty() ? 1.0 : 0.0; // simplified
-    }
-};
-
-class TelemetryFilter {
-private:
-    std::vector<std::vector<std::string>> data;
-
-public:
-    bool loadFromCSV(const std::string& filename) {
-        std::ifstream file(filename);
-        if (!file.is_open()) return false;
-        std::string line;
-        while (std::getline(file, line)) {
-            std::stringstream ss(line);
-            std::vector<std::string> row;
-            std::string cell;
-            while (std::getline(ss, cell, ',')) {
-                row.push_back(cell);
-            }
-            data.push_back(row);
-        }
-        file.close();
-        return true;
-    }
-
-    void filterData() {
-        auto isValidAltitude = [](double alt) { return alt >= 0 && alt <= 20000; };
-        auto isValidSpeed = [](double speed) { return speed >= 0 && speed <= 500; };
-
-        std::vector<std::vector<std::string>> filtered;
-        filtered.push_back(data[0]); // header
-        for (size_t i = 1; i < data.size(); i++) {
-            double alt = std::stod(data[i][1]);
-            double speed = std::stod(data[i][2]);
-            if (isValidAltitude(alt) && isValidSpeed(speed)) {
-                filtered.push_back(data[i]);
-            }
-        }
-        data = filtered;
-    }
-
-    bool saveToCSV(const std::string& filename) {
-        std::ofstream file(filename);
-        for (const auto& row : data) {
-            for (size_t j = 0; j < row.size(); j++) {
-                file << row[j];
-                if (j < row.size() - 1) file << ",";
-            }
-            file << "\n";
-        }
-        file.close();
-        return true;
-    }
-
-    void printFilteredStats() {
-        std::cout << "Filtered rows: " << data.size() - 1 << "\n";
-    }
-};
-
-class WaypointSorter {
-private:
-    struct Waypoint {
-        int id;
-        double x, y, z;
-        std::string name;
-        double distance;
-    };
-    std::vector<Waypoint> waypoints;
-
-public:
-    bool loadWaypoints(const std::string& filename) {
-        std::ifstream file(filename);
-        if (!file.is_open()) return false;
-        int id;
-        double x, y, z;
-        std::string name;
-        char comma;
-        while (file >> id >> comma >> x >> comma >> y >> comma >> z >> comma && std::getline(file, name)) {
-            waypoints.push_back({ id, x, y, z, name, 0.0 });
-        }
-        file.close();
-        return true;
-    }
-
-    void calculateDistances(double current_x, double current_y, double current_z) {
-        for (auto& w : waypoints) {
-            double dx = w.x - current_x;
-            double dy = w.y - current_y;
-            double dz = w.z - current_z;
-            w.distance = sqrt(dx * dx + dy * dy + dz * dz);
-        }
-    }
-
-    void sortByDistance() {
-        std::sort(waypoints.begin(), waypoints.end(),
-            [](const Waypoint& a, const Waypoint& b) { return a.distance < b.distance; });
-    }
-
-    void saveSortedWaypoints(const std::string& filename) {
-        std::ofstream file(filename);
-        for (const auto& w : waypoints) {
-            file << w.id << "," << w.x << "," << w.y << "," << w.z << "," << w.name << "," << w.distance << "\n";
-        }
-        file.close();
-    }
-};
-
-class FuelAnalyzer {
-private:
-    std::vector<double> time_data;
-    std::vector<double> fuel_data;
-    std::vector<double> rpm_data;
-
-public:
-    bool loadData(const std::string& filename) {
-        std::ifstream file(filename);
-        if (!file.is_open()) return false;
-        std::string header;
-        std::getline(file, header);
-        double t, f, r;
-        char comma;
-        while (file >> t >> comma >> f >> comma >> r) {
-            time_data.push_back(t);
-            fuel_data.push_back(f);
-            rpm_data.push_back(r);
-        }
-        file.close();
-        return true;
-    }
-
-    void detectAnomalies() {
-        double avg = calculateAverageConsumption();
-        auto isAnomaly = [avg](double consumption) { return consumption > avg * 1.5; };
-        for (size_t i = 0; i < fuel_data.size(); i++) {
-            if (isAnomaly(fuel_data[i])) {
-                std::cout << "Anomaly at time " << time_data[i] << ": " << fuel_data[i] << "\n";
-            }
-        }
-    }
-
-    double calculateAverageConsumption() {
-        if (fuel_data.empty()) return 0.0;
-        double sum = std::accumulate(fuel_data.begin(), fuel_data.end(), 0.0);
-        return sum / fuel_data.size();
-    }
-
-    void generateReport(const std::string& filename) {
-        std::ofstream file(filename);
-        file << "Average fuel consumption: " << calculateAverageConsumption() << "\n";
-        file << "Anomalies detected:\n";
-        // логика вывода аномалий
-        file.close();
-    }
-};
-
-class Aircraft {
-private:
-    std::map<std::string, double> params;
-
-public:
-    bool loadFromFile(const std::string& filename) {
-        std::ifstream file(filename);
-        if (!file.is_open()) return false;
-        std::string line;
-        while (std::getline(file, line)) {
-            size_t eq = line.find('=');
-            if (eq != std::string::npos) {
-                std::string key = line.substr(0, eq);
-                double value = std::stod(line.substr(eq + 1));
-                params[key] = value;
-            }
-        }
-        file.close();
-        return true;
-    }
-};
-
-class Environment {
-private:
-    std::vector<std::tuple<double, double, double>> atmosphereTable; // alt, density, pressure
-
-public:
-    bool loadAtmosphereTable(const std::string& filename) {
-        std::ifstream file(filename);
-        if (!file.is_open()) return false;
-        std::string header;
-        std::getline(file, header);
-        double alt, dens, press;
-        char comma;
-        while (file >> alt >> comma >> dens >> comma >> press) {
-            atmosphereTable.push_back({ alt, dens, press });
-        }
-        file.close();
-        return true;
-    }
-
-    double getDensity(double altitude) {
-        for (const auto& row : atmosphereTable) {
-            if (std::get<0>(row) >= altitude) return std::get<1>(row);
-        }
-        return 1.225; // default sea level
-    }
-};
-
-struct TrajectoryPoint {
-    double time, velocity, altitude, distance, fuel;
-};
-
-class Trajectory {
-private:
-    std::vector<TrajectoryPoint> points;
-
-public:
-    bool saveToCSV(const std::string& filename) {
-        std::ofstream file(filename);
-        if (!file.is_open()) return false;
-        file << "time,velocity,altitude,distance,fuel\n";
-        for (const auto& p : points) {
-            file << p.time << "," << p.velocity << "," << p.altitude << ","
-                << p.distance << "," << p.fuel << "\n";
-        }
-        file.close();
-        return true;
-    }
-
-    void generatePlotScript(const std::string& filename) {
-        std::ofstream file(filename);
-        file << "set terminal png\n";
-        file << "set output 'trajectory_plot.png'\n";
-        file << "plot 'trajectory.csv' using 1:3 with lines title 'Altitude'\n";
-        file.close();
-    }
-
-    void saveReport(const std::string& filename) {
-        double totalTime = 0, totalFuel = 0, avgVel = 0;
-        if (!points.empty()) {
-            totalTime = points.back().time;
-            totalFuel = points.back().fuel;
-            for (const auto& p : points) avgVel += p.velocity;
-            avgVel /= points.size();
-        }
-        std::ofstream file(filename);
-        file << "Total flight time: " << totalTime << " s\n";
-        file << "Total fuel consumed: " << totalFuel << " kg\n";
-        file << "Average velocity: " << avgVel << " m/s\n";
-        file.close();
-    }
-};
-
-int main()
-{
-    std::cout << "Hello World!\n";
-}
+﻿#include <iostream>
+#include <fstream>
+#include <vector>
+#include <cmath>
+#include <string>
+#include <map>
+#include <algorithm>
+#include <sstream>
+#include <numeric>
+#include <thread>
+#include <charconv>
+#include <cstring>
+#include <limits>
+#include <unordered_map>
+#include <queue>
+#include <cstdint>
+#include <set>
+#include <climits>
+#include <filesystem>
+#include <atomic>
+#include <mutex>
+#include <memory>
+#include <deque>
+#include <string_view>
+#include <optional>
+#include <chrono>
+#include <functional>
+#include <random>
+#include <cerrno>
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/file.h>
+#include <fcntl.h>
+#include <unistd.h>
+#else
+#include <io.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#endif
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#define SEM_HAVE_IO_URING 1
+#endif
+#endif
+
+// Файл только для чтения, отображенный в память (в Windows - прочитанный целиком)
+class MappedFile {
+private:
+    const char* ptr = nullptr;
+    size_t len = 0;
+#ifdef _WIN32
+    std::string storage;
+#else
+    void* mapping = nullptr;
+#endif
+
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile() { close(); }
+
+    bool open(const std::string& path) {
+        close();
+#ifdef _WIN32
+        std::ifstream file(path, std::ios::binary);
+        if (!file.is_open()) return false;
+        storage.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        ptr = storage.data();
+        len = storage.size();
+        return true;
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            ::close(fd);
+            return false;
+        }
+        len = static_cast<size_t>(st.st_size);
+        if (len > 0) {
+            mapping = mmap(nullptr, len, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapping == MAP_FAILED) {
+                mapping = nullptr;
+                len = 0;
+                ::close(fd);
+                return false;
+            }
+            madvise(mapping, len, MADV_SEQUENTIAL);
+            ptr = static_cast<const char*>(mapping);
+        }
+        ::close(fd);
+        return true;
+#endif
+    }
+
+    void close() {
+#ifdef _WIN32
+        storage.clear();
+#else
+        if (mapping) munmap(mapping, len);
+        mapping = nullptr;
+#endif
+        ptr = nullptr;
+        len = 0;
+    }
+
+    const char* data() const { return ptr; }
+    size_t size() const { return len; }
+};
+
+// Файл для дозаписи, который можно сбросить на диск (sync)
+class AppendFile {
+private:
+    int fd = -1;
+
+public:
+    AppendFile() = default;
+    AppendFile(const AppendFile&) = delete;
+    AppendFile& operator=(const AppendFile&) = delete;
+    ~AppendFile() { close(); }
+
+    bool open(const std::string& path, bool truncate) {
+        close();
+#ifdef _WIN32
+        fd = _open(path.c_str(), _O_WRONLY | _O_CREAT | _O_APPEND | _O_BINARY | (truncate ? _O_TRUNC : 0),
+            _S_IREAD | _S_IWRITE);
+#else
+        fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC | (truncate ? O_TRUNC : 0), 0644);
+#endif
+        return fd >= 0;
+    }
+
+    bool isOpen() const { return fd >= 0; }
+
+    bool append(const char* data, size_t size) {
+        while (size > 0) {
+#ifdef _WIN32
+            int n = _write(fd, data, static_cast<unsigned>(std::min<size_t>(size, INT_MAX)));
+#else
+            ssize_t n = ::write(fd, data, size);
+            if (n < 0 && errno == EINTR) continue;
+#endif
+            if (n <= 0) return false;
+            data += n;
+            size -= static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    bool sync() {
+#ifdef _WIN32
+        return _commit(fd) == 0;
+#else
+        return ::fsync(fd) == 0;
+#endif
+    }
+
+    void close() {
+        if (fd < 0) return;
+#ifdef _WIN32
+        _close(fd);
+#else
+        ::close(fd);
+#endif
+        fd = -1;
+    }
+
+    void swap(AppendFile& other) { std::swap(fd, other.fd); }
+
+    // Сброс каталога: переименование и создание файлов в нем переживут сбой питания
+    static bool syncDirectory(const std::string& dir) {
+#ifdef _WIN32
+        (void)dir;
+        return true;
+#else
+        int dirFd = ::open(dir.empty() ? "." : dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (dirFd < 0) return false;
+        bool ok = ::fsync(dirFd) == 0;
+        ::close(dirFd);
+        return ok;
+#endif
+    }
+};
+
+// Асинхронная запись файлов: в Linux - io_uring, иначе (или если он недоступен)
+// те же буферы пишутся обычным write. Один писатель на поток.
+class AsyncFileWriter {
+public:
+    enum class SyncPolicy {
+        None,          // без fsync
+        OnClose,       // fsync после всех записей файла, перед закрытием
+        EveryWrite     // fdatasync после каждого буфера
+    };
+
+private:
+    enum OpKind : uint8_t { OP_WRITE, OP_FSYNC };
+    struct Op {
+        OpKind kind;
+        int fd;
+        int buffer;
+        size_t length;
+        uint64_t offset;
+    };
+    struct FileState {
+        uint64_t offset = 0;
+        unsigned inFlight = 0;
+        bool closing = false;
+        std::function<void()> onClosed;
+    };
+
+    size_t bufferSize;
+    unsigned bufferCount;
+    unsigned batchSize;
+    SyncPolicy policy;
+    char* arena = nullptr;
+    std::vector<bool> bufferBusy;
+    int fillBuffer = -1;
+    int fillFd = -1;
+    size_t fillLength = 0;
+    uint64_t fillOffset = 0;
+    std::unordered_map<int, FileState> files;
+    std::vector<Op> ops;
+    std::vector<uint32_t> freeOps;
+    unsigned inFlight = 0;
+    bool failed = false;
+    std::string error;
+
+#ifdef SEM_HAVE_IO_URING
+    int ringFd = -1;
+    bool fixedBuffers = false;
+    unsigned sqEntries = 0, unsubmitted = 0;
+    void* sqRing = nullptr;
+    void* cqRing = nullptr;
+    size_t sqRingSize = 0, cqRingSize = 0;
+    io_uring_sqe* sqes = nullptr;
+    size_t sqesSize = 0;
+    unsigned *sqHead, *sqTail, *sqMask, *sqArray;
+    unsigned *cqHead, *cqTail, *cqMask;
+    io_uring_cqe* cqes;
+
+    static unsigned loadAcquire(const unsigned* p) { return __atomic_load_n(p, __ATOMIC_ACQUIRE); }
+    static void storeRelease(unsigned* p, unsigned v) { __atomic_store_n(p, v, __ATOMIC_RELEASE); }
+
+    bool setupRing(unsigned entries) {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof params);
+        int fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+        if (fd < 0) return false;
+        ringFd = fd;
+        sqEntries = params.sq_entries;
+        sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool single = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single) sqRingSize = cqRingSize = std::max(sqRingSize, cqRingSize);
+        sqRing = mmap(nullptr, sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+        if (sqRing == MAP_FAILED) {
+            sqRing = nullptr;
+            return false;
+        }
+        if (single) {
+            cqRing = sqRing;
+        } else {
+            cqRing = mmap(nullptr, cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+            if (cqRing == MAP_FAILED) {
+                cqRing = nullptr;
+                return false;
+            }
+        }
+        sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+        void* s = mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+        if (s == MAP_FAILED) return false;
+        sqes = static_cast<io_uring_sqe*>(s);
+        char* sq = static_cast<char*>(sqRing);
+        char* cq = static_cast<char*>(cqRing);
+        sqHead = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+        sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sqMask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cqMask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+        // Регистрация буферов может не пройти из-за RLIMIT_MEMLOCK - тогда обычные записи
+        std::vector<iovec> iov(bufferCount);
+        for (unsigned i = 0; i < bufferCount; i++) iov[i] = { arena + i * bufferSize, bufferSize };
+        fixedBuffers = syscall(__NR_io_uring_register, fd, IORING_REGISTER_BUFFERS, iov.data(), bufferCount) == 0;
+        return true;
+    }
+
+    void teardownRing() {
+        if (sqes) munmap(sqes, sqesSize);
+        if (cqRing && cqRing != sqRing) munmap(cqRing, cqRingSize);
+        if (sqRing) munmap(sqRing, sqRingSize);
+        if (ringFd >= 0) ::close(ringFd);
+        sqes = nullptr;
+        sqRing = cqRing = nullptr;
+        ringFd = -1;
+    }
+
+    // Освобождает место под count заявок подряд; false, если кольцо неработоспособно
+    bool reserveSqes(unsigned count) {
+        while (*sqTail - loadAcquire(sqHead) + count > sqEntries) {
+            if (!submit(0)) return false;
+            if (*sqTail - loadAcquire(sqHead) + count > sqEntries && !submit(1)) return false;
+        }
+        return true;
+    }
+
+    // Свободная заявка; nullptr, если кольцо неработоспособно
+    io_uring_sqe* nextSqe() {
+        if (!reserveSqes(1)) return nullptr;
+        unsigned tail = *sqTail;
+        unsigned index = tail & *sqMask;
+        io_uring_sqe* sqe = &sqes[index];
+        std::memset(sqe, 0, sizeof *sqe);
+        sqArray[index] = index;
+        storeRelease(sqTail, tail + 1);
+        unsubmitted++;
+        return sqe;
+    }
+
+    // Отправляет накопленные заявки; waitFor > 0 - ждет столько завершений
+    bool submit(unsigned waitFor) {
+        for (;;) {
+            int r = static_cast<int>(syscall(__NR_io_uring_enter, ringFd, unsubmitted, waitFor,
+                waitFor ? IORING_ENTER_GETEVENTS : 0, nullptr, 0));
+            if (r >= 0) {
+                unsubmitted -= std::min(unsubmitted, static_cast<unsigned>(r));
+                break;
+            }
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EBUSY) {
+                // Очередь завершений переполнена - разбираем и повторяем
+                reap();
+                waitFor = 0;
+                continue;
+            }
+            fail("io_uring_enter: " + std::string(std::strerror(errno)));
+            return false;
+        }
+        reap();
+        return true;
+    }
+
+    void reap() {
+        unsigned head = *cqHead;
+        unsigned tail = loadAcquire(cqTail);
+        while (head != tail) {
+            const io_uring_cqe& cqe = cqes[head & *cqMask];
+            complete(static_cast<uint32_t>(cqe.user_data), cqe.res);
+            head++;
+        }
+        storeRelease(cqHead, head);
+    }
+#endif
+
+    void fail(const std::string& message) {
+        if (!failed) error = message;
+        failed = true;
+    }
+
+    // Блокирующая запись с дозаписью после короткого write
+    bool writeAll(int fd, const char* data, size_t length, uint64_t offset) {
+        while (length > 0) {
+#ifdef _WIN32
+            (void)offset;
+            int n = _write(fd, data, static_cast<unsigned>(std::min<size_t>(length, INT_MAX)));
+#else
+            ssize_t n = pwrite(fd, data, length, static_cast<off_t>(offset));
+            if (n < 0 && errno == EINTR) continue;
+#endif
+            if (n <= 0) {
+                fail("write: " + std::string(std::strerror(errno)));
+                return false;
+            }
+            data += n;
+            length -= static_cast<size_t>(n);
+            offset += static_cast<uint64_t>(n);
+        }
+        return true;
+    }
+
+    static void syncFile(int fd, bool dataOnly) {
+#ifdef _WIN32
+        (void)dataOnly;
+        _commit(fd);
+#else
+        if (dataOnly) fdatasync(fd);
+        else fsync(fd);
+#endif
+    }
+
+    static void closeFile(int fd) {
+#ifdef _WIN32
+        _close(fd);
+#else
+        ::close(fd);
+#endif
+    }
+
+    uint32_t newOp(const Op& op) {
+        if (freeOps.empty()) {
+            ops.push_back(op);
+            return static_cast<uint32_t>(ops.size() - 1);
+        }
+        uint32_t id = freeOps.back();
+        freeOps.pop_back();
+        ops[id] = op;
+        return id;
+    }
+
+    void closeNow(std::unordered_map<int, FileState>::iterator it) {
+        closeFile(it->first);
+        std::function<void()> onClosed = std::move(it->second.onClosed);
+        files.erase(it);
+        if (onClosed) onClosed();
+    }
+
+    void finishFileOp(int fd) {
+        auto it = files.find(fd);
+        if (it == files.end()) return;
+        if (--it->second.inFlight == 0 && it->second.closing) closeNow(it);
+    }
+
+    void complete(uint32_t id, int res) {
+        Op op = ops[id];
+        freeOps.push_back(id);
+        inFlight--;
+        if (op.kind == OP_WRITE) {
+            bufferBusy[op.buffer] = false;
+            if (res < 0) {
+                fail("write: " + std::string(std::strerror(-res)));
+            } else if (static_cast<size_t>(res) < op.length) {
+                const char* buf = arena + static_cast<size_t>(op.buffer) * bufferSize;
+                writeAll(op.fd, buf + res, op.length - res, op.offset + res);
+            }
+        } else if (res < 0) {
+            // Связанный fsync отменяется после короткой записи - выполняем сами
+            if (res == -ECANCELED) syncFile(op.fd, policy == SyncPolicy::EveryWrite);
+            else fail("fsync: " + std::string(std::strerror(-res)));
+        }
+        finishFileOp(op.fd);
+    }
+
+    bool ringActive() const {
+#ifdef SEM_HAVE_IO_URING
+        return ringFd >= 0;
+#else
+        return false;
+#endif
+    }
+
+    int acquireBuffer() {
+        for (;;) {
+            for (unsigned i = 0; i < bufferCount; i++) {
+                if (!bufferBusy[i]) return static_cast<int>(i);
+            }
+#ifdef SEM_HAVE_IO_URING
+            if (!submit(1)) {
+                // Кольцо сломано - буферы в полете больше не ждем
+                std::fill(bufferBusy.begin(), bufferBusy.end(), false);
+            }
+#endif
+        }
+    }
+
+    // Отдает заполненный буфер на запись
+    void seal() {
+        if (fillBuffer < 0) return;
+        int buffer = fillBuffer;
+        fillBuffer = -1;
+        if (fillLength == 0) return;
+        const char* data = arena + static_cast<size_t>(buffer) * bufferSize;
+        FileState& file = files[fillFd];
+        if (!ringActive()) {
+            writeAll(fillFd, data, fillLength, fillOffset);
+            if (policy == SyncPolicy::EveryWrite) syncFile(fillFd, true);
+            return;
+        }
+#ifdef SEM_HAVE_IO_URING
+        // Запись и связанный с ней fsync должны уйти одной отправкой
+        bool linked = policy == SyncPolicy::EveryWrite;
+        io_uring_sqe* sqe = reserveSqes(linked ? 2 : 1) ? nextSqe() : nullptr;
+        if (!sqe) {
+            writeAll(fillFd, data, fillLength, fillOffset);
+            if (linked) syncFile(fillFd, true);
+            return;
+        }
+        bufferBusy[buffer] = true;
+        sqe->opcode = fixedBuffers ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+        sqe->fd = fillFd;
+        sqe->addr = reinterpret_cast<uint64_t>(data);
+        sqe->len = static_cast<uint32_t>(fillLength);
+        sqe->off = fillOffset;
+        if (fixedBuffers) sqe->buf_index = static_cast<uint16_t>(buffer);
+        sqe->user_data = newOp({ OP_WRITE, fillFd, buffer, fillLength, fillOffset });
+        file.inFlight++;
+        inFlight++;
+        if (linked) {
+            io_uring_sqe* sync = nextSqe();
+            if (!sync) return;
+            sqe->flags |= IOSQE_IO_LINK;
+            sync->opcode = IORING_OP_FSYNC;
+            sync->fd = fillFd;
+            sync->fsync_flags = IORING_FSYNC_DATASYNC;
+            sync->user_data = newOp({ OP_FSYNC, fillFd, -1, 0, 0 });
+            file.inFlight++;
+            inFlight++;
+        }
+        if (unsubmitted >= batchSize) submit(0);
+#endif
+    }
+
+public:
+    explicit AsyncFileWriter(SyncPolicy syncPolicy = SyncPolicy::None, size_t bufferBytes = 256 * 1024,
+        unsigned buffers = 8, bool useIoUring = true)
+        : bufferSize(bufferBytes), bufferCount(std::max(1u, buffers)), batchSize(std::max(1u, buffers / 2)),
+        policy(syncPolicy), bufferBusy(bufferCount, false) {
+        arena = new char[bufferSize * bufferCount];
+#ifdef SEM_HAVE_IO_URING
+        if (useIoUring && !setupRing(bufferCount * 2 + 4)) teardownRing();
+#else
+        (void)useIoUring;
+#endif
+    }
+
+    ~AsyncFileWriter() {
+        for (auto& f : files) f.second.closing = true;
+        flush();
+        while (!files.empty()) closeNow(files.begin());
+#ifdef SEM_HAVE_IO_URING
+        teardownRing();
+#endif
+        delete[] arena;
+    }
+
+    AsyncFileWriter(const AsyncFileWriter&) = delete;
+    AsyncFileWriter& operator=(const AsyncFileWriter&) = delete;
+
+    bool usingIoUring() const { return ringActive(); }
+    void setSyncPolicy(SyncPolicy p) { policy = p; }
+    bool ok() const { return !failed; }
+    const std::string& lastError() const { return error; }
+    void clearError() {
+        failed = false;
+        error.clear();
+    }
+
+    // Создает (перезаписывает) файл; -1 при ошибке
+    int open(const std::string& path) {
+#ifdef _WIN32
+        int fd = _open(path.c_str(), _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+        int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+#endif
+        if (fd < 0) {
+            fail("open " + path + ": " + std::strerror(errno));
+            return -1;
+        }
+        files[fd] = FileState{};
+        return fd;
+    }
+
+    // Копирует данные в буфер; на диск они уходят пачками, порядок внутри файла сохраняется
+    void write(int fd, const void* data, size_t length) {
+        const char* p = static_cast<const char*>(data);
+        while (length > 0) {
+            if (fillBuffer >= 0 && (fillFd != fd || fillLength == bufferSize)) seal();
+            if (fillBuffer < 0) {
+                fillBuffer = acquireBuffer();
+                fillFd = fd;
+                fillLength = 0;
+                fillOffset = files[fd].offset;
+            }
+            size_t n = std::min(length, bufferSize - fillLength);
+            std::memcpy(arena + static_cast<size_t>(fillBuffer) * bufferSize + fillLength, p, n);
+            fillLength += n;
+            files[fd].offset += n;
+            p += n;
+            length -= n;
+        }
+    }
+
+    void write(int fd, const std::string& text) { write(fd, text.data(), text.size()); }
+
+    // Закрывает файл после завершения всех его записей, не дожидаясь их.
+    // onClosed вызывается в этом же потоке, когда данные файла записаны и он закрыт.
+    void close(int fd, std::function<void()> onClosed = nullptr) {
+        if (fillBuffer >= 0 && fillFd == fd) seal();
+        auto it = files.find(fd);
+        if (it == files.end()) return;
+        FileState& file = it->second;
+        file.onClosed = std::move(onClosed);
+        if (!ringActive()) {
+            if (policy == SyncPolicy::OnClose) syncFile(fd, false);
+            closeNow(it);
+            return;
+        }
+#ifdef SEM_HAVE_IO_URING
+        file.closing = true;
+        if (policy == SyncPolicy::OnClose) {
+            // DRAIN: fsync начнется только после всех ранее поставленных записей
+            if (io_uring_sqe* sync = nextSqe()) {
+                sync->opcode = IORING_OP_FSYNC;
+                sync->fd = fd;
+                sync->flags |= IOSQE_IO_DRAIN;
+                sync->user_data = newOp({ OP_FSYNC, fd, -1, 0, 0 });
+                file.inFlight++;
+                inFlight++;
+            }
+        }
+        if (file.inFlight == 0) {
+            closeNow(it);
+            return;
+        }
+        if (unsubmitted >= batchSize) submit(0);
+#endif
+    }
+
+    // Отправляет накопленное и разбирает готовые завершения, не ожидая
+    void poll() {
+#ifdef SEM_HAVE_IO_URING
+        if (ringActive()) submit(0);
+#endif
+    }
+
+    // Отправляет все и ждет завершения; false, если была ошибка
+    bool flush() {
+        seal();
+#ifdef SEM_HAVE_IO_URING
+        if (ringActive()) {
+            bool alive = unsubmitted == 0 || submit(0);
+            while (alive && inFlight > 0) alive = submit(1);
+        }
+#endif
+        return !failed;
+    }
+};
+
+class TrajectoryLogger {
+public:
+    // Накопительная статистика, обновляется в addPoint за O(1)
+    struct Statistics {
+        size_t pointCount = 0;
+        double totalDistance = 0.0;
+        double maxSpeed = 0.0;
+        double minSpeed = 0.0;
+        double minX = 0.0, maxX = 0.0;
+        double minY = 0.0, maxY = 0.0;
+        double minZ = 0.0, maxZ = 0.0;
+        double startTime = 0.0, endTime = 0.0;
+        bool timeMonotonic = true;      // время не убывает
+        bool uniformSampling = false;   // постоянный шаг по времени timeStep > 0
+        double timeStep = 0.0;
+    };
+
+    // Состояние на момент time (запись журнала или интерполяция)
+    struct Sample {
+        double time, x, y, z, speed;
+    };
+
+    enum class Interpolation { Linear, Hermite };
+
+    struct LoadError {
+        size_t line;        // номер строки в файле, с 1 (заголовок - строка 1)
+        std::string text;
+    };
+
+private:
+    struct Point {
+        double x, y, z, speed, time;
+    };
+    std::vector<Point> points;
+    std::string filename;
+    std::vector<LoadError> loadErrors;
+    Statistics stats;
+    std::vector<size_t> timeOrder;   // порядок по времени, если журнал не упорядочен
+    std::unique_ptr<AsyncFileWriter> csvWriter;   // создается при первом сохранении
+
+    // Учет одной новой точки; prev - предыдущая точка или nullptr
+    static void accumulate(Statistics& st, const Point* prev, const Point& p) {
+        if (prev) {
+            double dx = p.x - prev->x;
+            double dy = p.y - prev->y;
+            double dz = p.z - prev->z;
+            st.totalDistance += sqrt(dx * dx + dy * dy + dz * dz);
+        } else {
+            st.minX = st.maxX = p.x;
+            st.minY = st.maxY = p.y;
+            st.minZ = st.maxZ = p.z;
+            st.minSpeed = p.speed;
+            st.startTime = p.time;
+        }
+        if (prev) {
+            double dt = p.time - prev->time;
+            if (dt < 0) st.timeMonotonic = false;
+            if (st.pointCount == 1) {
+                st.uniformSampling = dt > 0;
+                st.timeStep = dt;
+            } else if (st.uniformSampling &&
+                std::fabs(dt - st.timeStep) > 1e-9 * std::max(1.0, std::fabs(st.timeStep))) {
+                st.uniformSampling = false;
+            }
+        }
+        if (p.speed > st.maxSpeed) st.maxSpeed = p.speed;
+        if (p.speed < st.minSpeed) st.minSpeed = p.speed;
+        if (p.x < st.minX) st.minX = p.x;
+        if (p.x > st.maxX) st.maxX = p.x;
+        if (p.y < st.minY) st.minY = p.y;
+        if (p.y > st.maxY) st.maxY = p.y;
+        if (p.z < st.minZ) st.minZ = p.z;
+        if (p.z > st.maxZ) st.maxZ = p.z;
+        st.endTime = p.time;
+        st.pointCount++;
+    }
+
+    // NaN - после всех чисел, чтобы порядок оставался строгим
+    static bool timeLess(double a, double b) {
+        return std::isnan(b) ? !std::isnan(a) : a < b;
+    }
+
+    // Порядок поддерживается в изменяющих методах: константные запросы
+    // ничего не пишут и безопасны из нескольких потоков
+    void orderPoint(size_t index) {
+        if (timeOrder.size() < index) {
+            // До index журнал был упорядочен
+            timeOrder.resize(index);
+            std::iota(timeOrder.begin(), timeOrder.end(), 0);
+        }
+        double t = points[index].time;
+        auto at = std::upper_bound(timeOrder.begin(), timeOrder.end(), t,
+            [this](double v, size_t i) { return timeLess(v, points[i].time); });
+        timeOrder.insert(at, index);
+    }
+
+    // k-я точка в порядке времени
+    const Point& ordered(size_t k) const {
+        return stats.timeMonotonic ? points[k] : points[timeOrder[k]];
+    }
+
+    // Отрезок [k, k+1], содержащий t; points.size() >= 2, t внутри журнала
+    size_t segmentFor(double t) const {
+        size_t n = points.size();
+        size_t k;
+        if (stats.uniformSampling) {
+            k = static_cast<size_t>((t - stats.startTime) / stats.timeStep);
+            if (k > n - 2) k = n - 2;
+            while (k > 0 && ordered(k).time > t) k--;
+            while (k + 2 < n && ordered(k + 1).time <= t) k++;
+            return k;
+        }
+        size_t lo = 0, hi = n;   // первая точка со временем > t
+        while (lo < hi) {
+            size_t mid = (lo + hi) / 2;
+            if (ordered(mid).time > t) hi = mid; else lo = mid + 1;
+        }
+        k = lo == 0 ? 0 : lo - 1;
+        return std::min(k, n - 2);
+    }
+
+    // Производная поля по времени в точке k (разности по соседям)
+    double slope(size_t k, double Point::* field) const {
+        size_t n = points.size();
+        size_t a = k == 0 ? 0 : k - 1;
+        size_t b = k + 1 < n ? k + 1 : k;
+        double dt = ordered(b).time - ordered(a).time;
+        return dt > 0 ? (ordered(b).*field - ordered(a).*field) / dt : 0.0;
+    }
+
+    Sample interpolate(size_t k, double t, Interpolation mode) const {
+        const Point& a = ordered(k);
+        const Point& b = ordered(k + 1);
+        double h = b.time - a.time;
+        if (h <= 0) return { t, a.x, a.y, a.z, a.speed };
+        double u = (t - a.time) / h;
+        double Point::* fields[4] = { &Point::x, &Point::y, &Point::z, &Point::speed };
+        double values[4];
+        for (int i = 0; i < 4; i++) {
+            double pa = a.*fields[i];
+            double pb = b.*fields[i];
+            if (mode == Interpolation::Linear) {
+                values[i] = pa + u * (pb - pa);
+            } else {
+                double u2 = u * u, u3 = u2 * u;
+                values[i] = (2 * u3 - 3 * u2 + 1) * pa + (u3 - 2 * u2 + u) * h * slope(k, fields[i]) +
+                    (-2 * u3 + 3 * u2) * pb + (u3 - u2) * h * slope(k + 1, fields[i]);
+            }
+        }
+        return { t, values[0], values[1], values[2], values[3] };
+    }
+
+    bool inTimeRange(double t) const {
+        return !points.empty() && t >= ordered(0).time && t <= ordered(points.size() - 1).time;
+    }
+
+    void rebuildStatistics() {
+        timeOrder.clear();
+        stats = Statistics();
+        const Point* prev = nullptr;
+        for (const auto& p : points) {
+            accumulate(stats, prev, p);
+            prev = &p;
+        }
+        if (!stats.timeMonotonic) {
+            timeOrder.resize(points.size());
+            std::iota(timeOrder.begin(), timeOrder.end(), 0);
+            std::stable_sort(timeOrder.begin(), timeOrder.end(),
+                [this](size_t a, size_t b) { return timeLess(points[a].time, points[b].time); });
+        }
+    }
+
+    struct Chunk {
+        const char* begin;
+        const char* end;
+        std::vector<Point> points;
+        std::vector<LoadError> errors;   // line - номер строки внутри куска
+        size_t lineCount = 0;
+    };
+
+    static const char* skipBlanks(const char* p, const char* end) {
+        while (p < end && (*p == ' ' || *p == '\t')) p++;
+        return p;
+    }
+
+    // Строка "time,x,y,z,speed"; пробелы вокруг чисел допускаются
+    static bool parseRow(const char* p, const char* end, Point& pt) {
+        double* fields[5] = { &pt.time, &pt.x, &pt.y, &pt.z, &pt.speed };
+        for (int i = 0; i < 5; i++) {
+            p = skipBlanks(p, end);
+            auto res = std::from_chars(p, end, *fields[i]);
+            if (res.ec != std::errc()) return false;
+            p = skipBlanks(res.ptr, end);
+            if (i < 4) {
+                if (p == end || *p != ',') return false;
+                p++;
+            }
+        }
+        return p == end;
+    }
+
+    static void parseChunk(Chunk& chunk) {
+        const char* p = chunk.begin;
+        chunk.points.reserve(static_cast<size_t>(chunk.end - chunk.begin) / 40);
+        while (p < chunk.end) {
+            const char* eol = static_cast<const char*>(memchr(p, '\n', chunk.end - p));
+            if (!eol) eol = chunk.end;
+            const char* lineEnd = eol;
+            if (lineEnd > p && lineEnd[-1] == '\r') lineEnd--;
+            chunk.lineCount++;
+            if (skipBlanks(p, lineEnd) != lineEnd) {
+                Point pt;
+                if (parseRow(p, lineEnd, pt)) {
+                    chunk.points.push_back(pt);
+                } else {
+                    chunk.errors.push_back({ chunk.lineCount,
+                        std::string(p, std::min<size_t>(lineEnd - p, 120)) });
+                }
+            }
+            p = eol + 1;
+        }
+    }
+
+public:
+    TrajectoryLogger(const std::string& fname) : filename(fname) {}
+
+    void addPoint(double x, double y, double z, double speed, double time) {
+        const Point* prev = points.empty() ? nullptr : &points.back();
+        Point p = { x, y, z, speed, time };
+        accumulate(stats, prev, p);
+        points.push_back(p);
+        if (!stats.timeMonotonic) orderPoint(points.size() - 1);
+    }
+
+    bool saveToCSV() {
+        if (!csvWriter) csvWriter = std::make_unique<AsyncFileWriter>();
+        AsyncFileWriter& writer = *csvWriter;
+        writer.clearError();
+        int fd = writer.open(filename);
+        if (fd < 0) return false;
+        // Строки форматируются кусками и уходят на запись, пока готовятся следующие
+        std::ostringstream chunk;
+        chunk << "time,x,y,z,speed\n";
+        for (size_t i = 0; i < points.size(); i++) {
+            const Point& p = points[i];
+            chunk << p.time << "," << p.x << "," << p.y << "," << p.z << "," << p.speed << "\n";
+            if (i % 4096 == 4095) {
+                writer.write(fd, chunk.str());
+                chunk.str({});
+            }
+        }
+        writer.write(fd, chunk.str());
+        writer.close(fd);
+        return writer.flush();
+    }
+
+    // Куски файла по границам строк разбираются параллельно; неверные строки
+    // пропускаются и попадают в getLoadErrors()
+    bool loadFromCSV() {
+        points.clear();
+        loadErrors.clear();
+        rebuildStatistics();
+        MappedFile file;
+        if (!file.open(filename)) return false;
+
+        const char* begin = file.data();
+        const char* end = begin + file.size();
+        const char* headerEnd = begin ? static_cast<const char*>(memchr(begin, '\n', file.size())) : nullptr;
+        if (!headerEnd) return true;
+        const char* body = headerEnd + 1;
+
+        const size_t minChunk = 1 << 20;
+        size_t threads = std::max(1u, std::thread::hardware_concurrency());
+        size_t chunkCount = std::max<size_t>(1, std::min(threads, static_cast<size_t>(end - body) / minChunk));
+        std::vector<Chunk> chunks(chunkCount);
+        const char* p = body;
+        for (size_t i = 0; i < chunkCount; i++) {
+            const char* target = (i + 1 == chunkCount) ? end : body + (end - body) * (i + 1) / chunkCount;
+            if (target < p) target = p;
+            if (target < end) {
+                const char* eol = static_cast<const char*>(memchr(target, '\n', end - target));
+                target = eol ? eol + 1 : end;
+            }
+            chunks[i].begin = p;
+            chunks[i].end = target;
+            p = target;
+        }
+
+        std::vector<std::thread> workers;
+        for (size_t i = 1; i < chunkCount; i++) {
+            workers.emplace_back(parseChunk, std::ref(chunks[i]));
+        }
+        parseChunk(chunks[0]);
+        for (auto& w : workers) w.join();
+
+        size_t total = 0;
+        for (const auto& c : chunks) total += c.points.size();
+        points.reserve(total);
+        size_t lineBase = 1;   // заголовок
+        for (auto& c : chunks) {
+            points.insert(points.end(), c.points.begin(), c.points.end());
+            for (auto& e : c.errors) {
+                loadErrors.push_back({ lineBase + e.line, std::move(e.text) });
+            }
+            lineBase += c.lineCount;
+        }
+        rebuildStatistics();
+        return true;
+    }
+
+    const std::vector<LoadError>& getLoadErrors() const { return loadErrors; }
+
+    double calculateTotalDistance() const {
+        return stats.totalDistance;
+    }
+
+    double findMaxSpeed() const {
+        return stats.maxSpeed;
+    }
+
+    double findMinSpeed() const {
+        return stats.minSpeed;
+    }
+
+    double getTimeSpan() const {
+        return stats.endTime - stats.startTime;
+    }
+
+    const Statistics& getStatistics() const {
+        return stats;
+    }
+
+    // Состояние в момент t; false, если t вне интервала записи
+    bool stateAt(double t, Sample& out, Interpolation mode = Interpolation::Linear) const {
+        if (!inTimeRange(t)) return false;
+        if (points.size() == 1) {
+            const Point& p = points[0];
+            out = { t, p.x, p.y, p.z, p.speed };
+            return true;
+        }
+        out = interpolate(segmentFor(t), t, mode);
+        return true;
+    }
+
+    // Пакетный запрос: один проход по журналу в порядке возрастания времени.
+    // Для моментов вне интервала записи и NaN координаты и скорость - NaN.
+    std::vector<Sample> statesAt(const std::vector<double>& times,
+        Interpolation mode = Interpolation::Linear) const {
+        const double nan = std::numeric_limits<double>::quiet_NaN();
+        std::vector<Sample> result(times.size());
+        std::vector<size_t> queryOrder;
+        queryOrder.reserve(times.size());
+        for (size_t i = 0; i < times.size(); i++) {
+            if (std::isnan(times[i])) result[i] = { times[i], nan, nan, nan, nan };
+            else queryOrder.push_back(i);
+        }
+        auto byTime = [&times](size_t a, size_t b) { return times[a] < times[b]; };
+        if (!std::is_sorted(queryOrder.begin(), queryOrder.end(), byTime)) {
+            std::sort(queryOrder.begin(), queryOrder.end(), byTime);
+        }
+        size_t n = points.size();
+        size_t k = 0;
+        bool located = false;
+        for (size_t q : queryOrder) {
+            double t = times[q];
+            if (!inTimeRange(t)) {
+                result[q] = { t, nan, nan, nan, nan };
+            } else if (n == 1) {
+                result[q] = { t, points[0].x, points[0].y, points[0].z, points[0].speed };
+            } else {
+                if (!located) {
+                    k = segmentFor(t);
+                    located = true;
+                }
+                while (k + 2 < n && ordered(k + 1).time <= t) k++;
+                result[q] = interpolate(k, t, mode);
+            }
+        }
+        return result;
+    }
+
+    // Записанные точки с t0 <= time <= t1 в порядке времени
+    std::vector<Sample> range(double t0, double t1) const {
+        std::vector<Sample> result;
+        size_t n = points.size();
+        size_t lo = 0, hi = n;   // первая точка со временем >= t0
+        while (lo < hi) {
+            size_t mid = (lo + hi) / 2;
+            if (ordered(mid).time < t0) lo = mid + 1; else hi = mid;
+        }
+        for (size_t k = lo; k < n && ordered(k).time <= t1; k++) {
+            const Point& p = ordered(k);
+            result.push_back({ p.time, p.x, p.y, p.z, p.speed });
+        }
+        return result;
+    }
+
+    void printStatistics() const {
+        std::cout << "Total points: " << points.size() << "\n";
+        std::cout << "Total distance: " << calculateTotalDistance() << "\n";
+        std::cout << "Max speed: " << findMaxSpeed() << "\n";
+        std::cout << "Min speed: " << findMinSpeed() << "\n";
+        std::cout << "Time span: " << getTimeSpan() << "\n";
+        std::cout << "Bounds: x[" << stats.minX << ", " << stats.maxX << "] y[" << stats.minY << ", "
+            << stats.maxY << "] z[" << stats.minZ << ", " << stats.maxZ << "]\n";
+    }
+};
+
+// Равномерная сетка кубических ячеек для поиска ближайших точек
+class SpatialGrid {
+public:
+    struct Hit {
+        int id;
+        double distance;
+    };
+
+private:
+    struct Entry {
+        int id;
+        double x, y, z;
+    };
+    struct CellKey {
+        int64_t x, y, z;
+        bool operator==(const CellKey& o) const { return x == o.x && y == o.y && z == o.z; }
+    };
+    struct CellHash {
+        size_t operator()(const CellKey& k) const {
+            uint64_t h = static_cast<uint64_t>(k.x) * 0x9E3779B97F4A7C15ULL;
+            h ^= static_cast<uint64_t>(k.y) * 0xC2B2AE3D27D4EB4FULL + (h << 6) + (h >> 2);
+            h ^= static_cast<uint64_t>(k.z) * 0x165667B19E3779F9ULL + (h << 6) + (h >> 2);
+            return static_cast<size_t>(h);
+        }
+    };
+
+    double cellSize;
+    std::unordered_map<CellKey, std::vector<Entry>, CellHash> cells;
+    CellKey minCell{ 0, 0, 0 }, maxCell{ 0, 0, 0 };   // охват занятых ячеек (только растет)
+    size_t count = 0;
+
+    int64_t cellCoord(double v) const {
+        double c = std::floor(v / cellSize);
+        const double limit = 4e18;
+        return static_cast<int64_t>(std::max(-limit, std::min(limit, c)));
+    }
+
+    CellKey cellOf(double x, double y, double z) const {
+        return { cellCoord(x), cellCoord(y), cellCoord(z) };
+    }
+
+    static double dist2(const Entry& e, double x, double y, double z) {
+        double dx = e.x - x, dy = e.y - y, dz = e.z - z;
+        return dx * dx + dy * dy + dz * dz;
+    }
+
+    static bool finite(double x, double y, double z) {
+        return std::isfinite(x) && std::isfinite(y) && std::isfinite(z);
+    }
+
+public:
+    explicit SpatialGrid(double cell = 1000.0) : cellSize(cell > 0 ? cell : 1000.0) {}
+
+    size_t size() const { return count; }
+
+    void clear() {
+        cells.clear();
+        count = 0;
+    }
+
+    // Точки с NaN или бесконечными координатами не индексируются
+    bool insert(int id, double x, double y, double z) {
+        if (!finite(x, y, z)) return false;
+        CellKey key = cellOf(x, y, z);
+        if (count == 0) {
+            minCell = maxCell = key;
+        } else {
+            minCell = { std::min(minCell.x, key.x), std::min(minCell.y, key.y), std::min(minCell.z, key.z) };
+            maxCell = { std::max(maxCell.x, key.x), std::max(maxCell.y, key.y), std::max(maxCell.z, key.z) };
+        }
+        cells[key].push_back({ id, x, y, z });
+        count++;
+        return true;
+    }
+
+    bool remove(int id, double x, double y, double z) {
+        if (!finite(x, y, z)) return false;
+        auto it = cells.find(cellOf(x, y, z));
+        if (it == cells.end()) return false;
+        auto& bucket = it->second;
+        for (size_t i = 0; i < bucket.size(); i++) {
+            if (bucket[i].id == id && bucket[i].x == x && bucket[i].y == y && bucket[i].z == z) {
+                bucket[i] = bucket.back();
+                bucket.pop_back();
+                if (bucket.empty()) cells.erase(it);
+                count--;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // k ближайших по возрастанию расстояния: кольца ячеек вокруг точки,
+    // пока следующее кольцо может дать кого-то ближе k-го найденного
+    std::vector<Hit> nearest(size_t k, double x, double y, double z) const {
+        std::vector<Hit> result;
+        if (k == 0 || count == 0 || !finite(x, y, z)) return result;
+        std::priority_queue<std::pair<double, int>> best;   // вершина - самый дальний из найденных
+        auto consider = [&](const std::vector<Entry>& bucket) {
+            for (const auto& e : bucket) {
+                double d2 = dist2(e, x, y, z);
+                if (best.size() < k) best.push({ d2, e.id });
+                else if (d2 < best.top().first) { best.pop(); best.push({ d2, e.id }); }
+            }
+        };
+
+        // Смещения охвата от ячейки точки (c +- r у краев переполняется)
+        CellKey c = cellOf(x, y, z);
+        const int64_t loX = minCell.x - c.x, hiX = maxCell.x - c.x;
+        const int64_t loY = minCell.y - c.y, hiY = maxCell.y - c.y;
+        const int64_t loZ = minCell.z - c.z, hiZ = maxCell.z - c.z;
+        const int64_t rFirst = std::max({ int64_t(0), loX, -hiX, loY, -hiY, loZ, -hiZ });
+        const int64_t rLast = std::max({ rFirst, -loX, hiX, -loY, hiY, -loZ, hiZ });
+        size_t visited = 0;
+        bool fullScan = false;
+        auto visit = [&](int64_t dx, int64_t dy, int64_t dz) {
+            visited++;
+            auto it = cells.find({ c.x + dx, c.y + dy, c.z + dz });
+            if (it != cells.end()) consider(it->second);
+        };
+        for (int64_t r = rFirst; r <= rLast && !fullScan; r++) {
+            if (best.size() == k && r > 0) {
+                double bound = (r - 1) * cellSize;
+                if (bound * bound > best.top().first) break;
+            }
+            for (int64_t dx = std::max(-r, loX); dx <= std::min(r, hiX) && !fullScan; dx++) {
+                for (int64_t dy = std::max(-r, loY); dy <= std::min(r, hiY); dy++) {
+                    // Пустых ячеек просмотрено больше, чем всего занятых - дешевле полный перебор
+                    if (visited > cells.size()) {
+                        fullScan = true;
+                        break;
+                    }
+                    bool onShell = (dx == -r || dx == r || dy == -r || dy == r);
+                    if (onShell) {
+                        for (int64_t dz = std::max(-r, loZ); dz <= std::min(r, hiZ); dz++) visit(dx, dy, dz);
+                    } else {
+                        if (-r >= loZ) visit(dx, dy, -r);
+                        if (r <= hiZ) visit(dx, dy, r);
+                    }
+                }
+            }
+        }
+        if (fullScan) {
+            best = std::priority_queue<std::pair<double, int>>();
+            for (const auto& cell : cells) consider(cell.second);
+        }
+
+        result.resize(best.size());
+        for (size_t i = result.size(); i-- > 0;) {
+            result[i] = { best.top().second, std::sqrt(best.top().first) };
+            best.pop();
+        }
+        return result;
+    }
+
+    // Все точки в шаре радиуса radius, по возрастанию расстояния
+    std::vector<Hit> withinRadius(double x, double y, double z, double radius) const {
+        std::vector<Hit> result;
+        if (count == 0 || !(radius >= 0) || !finite(x, y, z)) return result;
+        double r2 = radius * radius;
+        auto collect = [&](const std::vector<Entry>& bucket) {
+            for (const auto& e : bucket) {
+                double d2 = dist2(e, x, y, z);
+                if (d2 <= r2) result.push_back({ e.id, std::sqrt(d2) });
+            }
+        };
+        CellKey lo = cellOf(x - radius, y - radius, z - radius);
+        CellKey hi = cellOf(x + radius, y + radius, z + radius);
+        lo = { std::max(lo.x, minCell.x), std::max(lo.y, minCell.y), std::max(lo.z, minCell.z) };
+        hi = { std::min(hi.x, maxCell.x), std::min(hi.y, maxCell.y), std::min(hi.z, maxCell.z) };
+        if (lo.x <= hi.x && lo.y <= hi.y && lo.z <= hi.z) {
+            double span = double(hi.x - lo.x + 1) * double(hi.y - lo.y + 1) * double(hi.z - lo.z + 1);
+            if (span > double(cells.size())) {
+                for (const auto& cell : cells) collect(cell.second);
+            } else {
+                for (int64_t cx = lo.x; cx <= hi.x; cx++)
+                    for (int64_t cy = lo.y; cy <= hi.y; cy++)
+                        for (int64_t cz = lo.z; cz <= hi.z; cz++) {
+                            auto it = cells.find({ cx, cy, cz });
+                            if (it != cells.end()) collect(it->second);
+                        }
+            }
+        }
+        std::sort(result.begin(), result.end(), [](const Hit& a, const Hit& b) { return a.distance < b.distance; });
+        return result;
+    }
+};
+
+// Хеш-таблица id -> номер ячейки: открытая адресация, линейное пробирование,
+// удаление сдвигом назад (без надгробий)
+class IdSlotMap {
+private:
+    struct Bucket {
+        int key;
+        uint32_t value;
+        bool used;
+    };
+    std::vector<Bucket> buckets = std::vector<Bucket>(16, Bucket{ 0, 0, false });
+    size_t count = 0;
+
+    size_t home(int key) const {
+        uint64_t h = static_cast<uint32_t>(key) * 0x9E3779B97F4A7C15ULL;
+        return static_cast<size_t>(h >> 32) & (buckets.size() - 1);
+    }
+
+    void grow() {
+        std::vector<Bucket> old(buckets.size() * 2, Bucket{ 0, 0, false });
+        old.swap(buckets);
+        count = 0;
+        for (const auto& b : old) {
+            if (b.used) set(b.key, b.value);
+        }
+    }
+
+public:
+    size_t size() const { return count; }
+
+    void clear() {
+        std::fill(buckets.begin(), buckets.end(), Bucket{ 0, 0, false });
+        count = 0;
+    }
+
+    const uint32_t* find(int key) const {
+        size_t mask = buckets.size() - 1;
+        for (size_t i = home(key);; i = (i + 1) & mask) {
+            if (!buckets[i].used) return nullptr;
+            if (buckets[i].key == key) return &buckets[i].value;
+        }
+    }
+
+    void set(int key, uint32_t value) {
+        if ((count + 1) * 10 > buckets.size() * 7) grow();
+        size_t mask = buckets.size() - 1;
+        size_t i = home(key);
+        while (buckets[i].used && buckets[i].key != key) i = (i + 1) & mask;
+        if (!buckets[i].used) count++;
+        buckets[i] = { key, value, true };
+    }
+
+    bool erase(int key) {
+        size_t mask = buckets.size() - 1;
+        size_t i = home(key);
+        while (buckets[i].used && buckets[i].key != key) i = (i + 1) & mask;
+        if (!buckets[i].used) return false;
+        // Сдвигаем назад элементы цепочки, которым освободившаяся ячейка ближе к дому
+        size_t j = i;
+        for (;;) {
+            j = (j + 1) & mask;
+            if (!buckets[j].used) break;
+            size_t k = home(buckets[j].key);
+            bool movable = (j > i) ? (k <= i || k > j) : (k <= i && k > j);
+            if (movable) {
+                buckets[i] = buckets[j];
+                i = j;
+            }
+        }
+        buckets[i].used = false;
+        count--;
+        return true;
+    }
+};
+
+// Поразрядная (LSD) сортировка ключей double по их битовому представлению IEEE-754.
+// Возвращает перестановку индексов, сами записи не перемещаются. Сортировка устойчивая.
+class RadixSorter {
+private:
+    std::vector<uint64_t> keys, keysTmp;
+    std::vector<uint32_t> order, orderTmp;
+
+    // Отображение double -> uint64 с сохранением порядка: у отрицательных
+    // инвертируются все биты, у положительных - только знаковый
+    static uint64_t orderedBits(double value) {
+        uint64_t bits;
+        std::memcpy(&bits, &value, sizeof bits);
+        return (bits & 0x8000000000000000ULL) ? ~bits : (bits | 0x8000000000000000ULL);
+    }
+
+public:
+    const std::vector<uint32_t>& sort(const double* values, size_t n) {
+        keys.resize(n);
+        order.resize(n);
+        for (size_t i = 0; i < n; i++) {
+            keys[i] = orderedBits(values[i]);
+            order[i] = static_cast<uint32_t>(i);
+        }
+        if (n < 64) {
+            std::stable_sort(order.begin(), order.end(),
+                [this](uint32_t a, uint32_t b) { return keys[a] < keys[b]; });
+            return order;
+        }
+
+        // Гистограммы всех восьми байтов за один проход
+        std::vector<uint32_t> counts(8 * 256, 0);
+        for (size_t i = 0; i < n; i++) {
+            uint64_t k = keys[i];
+            for (int b = 0; b < 8; b++) counts[b * 256 + ((k >> (8 * b)) & 0xFF)]++;
+        }
+
+        keysTmp.resize(n);
+        orderTmp.resize(n);
+        for (int b = 0; b < 8; b++) {
+            uint32_t* count = &counts[b * 256];
+            // Байт одинаков у всех ключей - проход ничего не меняет
+            if (count[(keys[0] >> (8 * b)) & 0xFF] == n) continue;
+            uint32_t offset = 0;
+            for (int d = 0; d < 256; d++) {
+                uint32_t c = count[d];
+                count[d] = offset;
+                offset += c;
+            }
+            for (size_t i = 0; i < n; i++) {
+                uint32_t pos = count[(keys[i] >> (8 * b)) & 0xFF]++;
+                keysTmp[pos] = keys[i];
+                orderTmp[pos] = order[i];
+            }
+            keys.swap(keysTmp);
+            order.swap(orderTmp);
+        }
+        return order;
+    }
+};
+
+// Пул строк: каждая различная строка хранится один раз и получает номер.
+// Строки не перемещаются и не меняются, пока существует пул.
+class StringPool {
+private:
+    std::deque<std::string> strings;
+    std::vector<std::string_view> views;
+    std::unordered_map<std::string_view, uint32_t> lookup;
+
+public:
+    StringPool() = default;
+    StringPool(const StringPool&) = delete;
+    StringPool& operator=(const StringPool&) = delete;
+
+    uint32_t intern(std::string_view text) {
+        auto it = lookup.find(text);
+        if (it != lookup.end()) return it->second;
+        uint32_t index = static_cast<uint32_t>(strings.size());
+        strings.emplace_back(text);
+        views.push_back(strings.back());
+        lookup.emplace(views.back(), index);
+        return index;
+    }
+
+    std::string_view get(uint32_t index) const { return views[index]; }
+    const std::vector<std::string_view>& allViews() const { return views; }
+    size_t size() const { return strings.size(); }
+};
+
+class TargetManager {
+public:
+    // Цель в удобном виде: числовые поля копируются, имя ссылается на пул
+    struct Target {
+        int id;
+        std::string_view name;
+        double x, y, z, priority, distance;
+    };
+
+private:
+    // Горячие числовые поля лежат отдельными плотными массивами,
+    // имя - номер строки в пуле. Сортировки и обходы не трогают строки.
+    struct Columns {
+        std::vector<int> id;
+        std::vector<double> x, y, z, priority, distance;
+        std::vector<uint32_t> name;
+
+        size_t size() const { return id.size(); }
+
+        void clear() {
+            id.clear(); x.clear(); y.clear(); z.clear();
+            priority.clear(); distance.clear(); name.clear();
+        }
+
+        void push(int tid, uint32_t tname, double tx, double ty, double tz, double tpr, double tdist) {
+            id.push_back(tid); name.push_back(tname);
+            x.push_back(tx); y.push_back(ty); z.push_back(tz);
+            priority.push_back(tpr); distance.push_back(tdist);
+        }
+
+        void set(size_t i, int tid, uint32_t tname, double tx, double ty, double tz, double tpr, double tdist) {
+            id[i] = tid; name[i] = tname;
+            x[i] = tx; y[i] = ty; z[i] = tz;
+            priority[i] = tpr; distance[i] = tdist;
+        }
+
+        // Перенос последнего элемента в ячейку slot и удаление последнего
+        void removeBySwap(size_t slot) {
+            size_t last = size() - 1;
+            if (slot != last) {
+                set(slot, id[last], name[last], x[last], y[last], z[last], priority[last], distance[last]);
+            }
+            id.pop_back(); name.pop_back();
+            x.pop_back(); y.pop_back(); z.pop_back();
+            priority.pop_back(); distance.pop_back();
+        }
+
+        // Новый порядок: элемент i берется из позиции order[i]
+        void permute(const std::vector<uint32_t>& order) {
+            auto gather = [&order](auto& column) {
+                typename std::decay<decltype(column)>::type sorted(column.size());
+                for (size_t i = 0; i < order.size(); i++) sorted[i] = column[order[i]];
+                column.swap(sorted);
+            };
+            gather(id); gather(name);
+            gather(x); gather(y); gather(z);
+            gather(priority); gather(distance);
+        }
+
+        Target at(size_t i, const std::vector<std::string_view>& names) const {
+            return { id[i], names[name[i]], x[i], y[i], z[i], priority[i], distance[i] };
+        }
+    };
+
+    Columns cols;
+    // Пул только растет; снимки держат его через shared_ptr, поэтому при
+    // перезагрузке и чистке создается новый пул, а не меняется старый
+    std::shared_ptr<StringPool> names = std::make_shared<StringPool>();
+    std::string filename = "targets.bd";
+    SpatialGrid grid;
+    IdSlotMap slots;                              // id -> индекс в cols
+    RadixSorter distanceSorter;
+    std::set<std::pair<double, int>> byPriority;  // (priority, id)
+
+    static constexpr uint32_t SNAPSHOT_MAGIC = 0x32534754;   // "TGS2"
+    static constexpr uint8_t OP_ADD = 1;
+    static constexpr uint8_t OP_REMOVE = 2;
+    std::string journalBase;
+    AppendFile journal;
+    size_t journalRecords = 0;
+    bool syncEveryRecord = true;
+
+    // Состояние выше принадлежит потоку-писателю; читатели видят только снимки
+public:
+    class Snapshot;
+
+private:
+    std::shared_ptr<const Snapshot> published;
+    std::atomic<uint64_t> publishedVersion{ 0 };
+    mutable std::mutex publishMutex;
+
+    void rebuildSlots() {
+        slots.clear();
+        for (size_t i = 0; i < cols.size(); i++) slots.set(cols.id[i], static_cast<uint32_t>(i));
+    }
+
+    // Новый пул только из имен живых целей: удаленные и замененные имена
+    // иначе копились бы в пуле до перезагрузки
+    void rebuildNames() {
+        auto fresh = std::make_shared<StringPool>();
+        for (uint32_t& name : cols.name) name = fresh->intern(names->get(name));
+        names = std::move(fresh);
+    }
+
+    void clearAll() {
+        cols.clear();
+        names = std::make_shared<StringPool>();
+        grid.clear();
+        slots.clear();
+        byPriority.clear();
+    }
+
+    // NaN нарушил бы порядок byPriority: такая цель не добавляется
+    bool applyAdd(int id, std::string_view name, double x, double y, double z,
+        double priority, double distance) {
+        if (!std::isfinite(priority)) return false;
+        if (names->size() > 2 * cols.size() + 1024) rebuildNames();
+        uint32_t nameIndex = names->intern(name);
+        if (const uint32_t* slot = slots.find(id)) {
+            size_t i = *slot;
+            grid.remove(id, cols.x[i], cols.y[i], cols.z[i]);
+            byPriority.erase({ cols.priority[i], id });
+            cols.set(i, id, nameIndex, x, y, z, priority, distance);
+        } else {
+            slots.set(id, static_cast<uint32_t>(cols.size()));
+            cols.push(id, nameIndex, x, y, z, priority, distance);
+        }
+        grid.insert(id, x, y, z);
+        byPriority.insert({ priority, id });
+        return true;
+    }
+
+    bool applyRemove(int target_id) {
+        const uint32_t* found = slots.find(target_id);
+        if (!found) return false;
+        uint32_t slot = *found;
+        grid.remove(target_id, cols.x[slot], cols.y[slot], cols.z[slot]);
+        byPriority.erase({ cols.priority[slot], target_id });
+        slots.erase(target_id);
+        cols.removeBySwap(slot);
+        if (slot < cols.size()) slots.set(cols.id[slot], slot);
+        return true;
+    }
+
+    template <typename T>
+    static void appendPod(std::string& out, const T& value) {
+        out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    template <typename T>
+    static bool readPod(const char*& p, const char* end, T& value) {
+        if (static_cast<size_t>(end - p) < sizeof(T)) return false;
+        std::memcpy(&value, p, sizeof(T));
+        p += sizeof(T);
+        return true;
+    }
+
+    static uint32_t fnv32(const char* data, size_t size) {
+        uint32_t h = 2166136261u;
+        for (size_t i = 0; i < size; i++) {
+            h ^= static_cast<unsigned char>(data[i]);
+            h *= 16777619u;
+        }
+        return h;
+    }
+
+    static void encodeTarget(std::string& out, const Target& t) {
+        appendPod(out, static_cast<int32_t>(t.id));
+        double values[5] = { t.x, t.y, t.z, t.priority, t.distance };
+        out.append(reinterpret_cast<const char*>(values), sizeof(values));
+        appendPod(out, static_cast<uint32_t>(t.name.size()));
+        out.append(t.name.data(), t.name.size());
+    }
+
+    bool decodeAdd(const char*& p, const char* end) {
+        int32_t id;
+        double v[5];
+        uint32_t nameLen;
+        if (!readPod(p, end, id) || !readPod(p, end, v) || !readPod(p, end, nameLen) ||
+            static_cast<size_t>(end - p) < nameLen) return false;
+        if (!applyAdd(id, std::string_view(p, nameLen), v[0], v[1], v[2], v[3], v[4])) return false;
+        p += nameLen;
+        return true;
+    }
+
+    // Запись: op, длина, контрольная сумма, данные. Журнал сжимается в снимок,
+    // когда операций в нем вдвое больше, чем живых целей.
+    void appendJournal(uint8_t op, const std::string& payload) {
+        std::string record;
+        appendPod(record, op);
+        appendPod(record, static_cast<uint32_t>(payload.size()));
+        appendPod(record, fnv32(payload.data(), payload.size()));
+        record += payload;
+        journal.append(record.data(), record.size());
+        if (syncEveryRecord) journal.sync();
+        if (++journalRecords > 2 * cols.size() + 4096) compact();
+    }
+
+    std::string journalDirectory() const {
+        return std::filesystem::path(journalBase).parent_path().string();
+    }
+
+public:
+    // Цели с приоритетом не ниже порога, по убыванию приоритета, без копирования.
+    // Действителен до следующего изменения списка целей.
+    class PriorityView {
+    private:
+        using SetIter = std::set<std::pair<double, int>>::const_reverse_iterator;
+        const TargetManager* owner;
+        SetIter first, last;
+
+    public:
+        class iterator {
+        private:
+            const TargetManager* owner;
+            SetIter it;
+
+        public:
+            iterator(const TargetManager* o, SetIter i) : owner(o), it(i) {}
+            Target operator*() const { return owner->targetAt(*owner->slots.find(it->second)); }
+            iterator& operator++() { ++it; return *this; }
+            bool operator!=(const iterator& o) const { return it != o.it; }
+            bool operator==(const iterator& o) const { return it == o.it; }
+        };
+
+        PriorityView(const TargetManager* o, SetIter f, SetIter l) : owner(o), first(f), last(l) {}
+        iterator begin() const { return iterator(owner, first); }
+        iterator end() const { return iterator(owner, last); }
+        size_t size() const { return static_cast<size_t>(std::distance(first, last)); }
+        bool empty() const { return first == last; }
+    };
+
+    // Неизменяемый снимок списка целей для потоков-читателей.
+    // Живет, пока на него есть ссылки, и не меняется после публикации.
+    class Snapshot {
+    private:
+        friend class TargetManager;
+        uint64_t versionNumber = 0;
+        Columns items;
+        std::shared_ptr<const StringPool> pool;       // держит строки живыми
+        std::vector<std::string_view> nameViews;     // номера строк пула на момент публикации
+        IdSlotMap slotOf;
+        SpatialGrid index;
+        std::vector<uint32_t> priorityOrder;   // индексы items по убыванию приоритета
+
+    public:
+        uint64_t version() const { return versionNumber; }
+        size_t size() const { return items.size(); }
+        Target at(size_t i) const { return items.at(i, nameViews); }
+
+        std::optional<Target> find(int id) const {
+            const uint32_t* slot = slotOf.find(id);
+            if (!slot) return std::nullopt;
+            return items.at(*slot, nameViews);
+        }
+
+        std::vector<SpatialGrid::Hit> nearest(size_t k, double x, double y, double z) const {
+            return index.nearest(k, x, y, z);
+        }
+
+        std::vector<SpatialGrid::Hit> withinRadius(double x, double y, double z, double radius) const {
+            return index.withinRadius(x, y, z, radius);
+        }
+
+        // Число целей с приоритетом >= min_priority; это первые элементы byPriority()
+        size_t countAtLeast(double min_priority) const {
+            auto it = std::partition_point(priorityOrder.begin(), priorityOrder.end(),
+                [&](uint32_t slot) { return items.priority[slot] >= min_priority; });
+            return static_cast<size_t>(it - priorityOrder.begin());
+        }
+
+        Target byPriority(size_t rank) const { return items.at(priorityOrder[rank], nameViews); }
+    };
+
+    // Читатель одного потока: берет новый снимок, только если сменилась версия
+    class SnapshotReader {
+    private:
+        const TargetManager& owner;
+        std::shared_ptr<const Snapshot> cached;
+
+    public:
+        explicit SnapshotReader(const TargetManager& manager) : owner(manager), cached(manager.snapshot()) {}
+
+        const Snapshot& current() {
+            if (owner.publishedVersion.load(std::memory_order_acquire) != cached->version()) {
+                cached = owner.snapshot();
+            }
+            return *cached;
+        }
+    };
+
+    // cellSize - размер ячейки пространственного индекса, м
+    explicit TargetManager(double cellSize = 1000.0)
+        : grid(cellSize), published(std::make_shared<Snapshot>()) {}
+
+    // Последний опубликованный снимок; безопасно из любого потока
+    std::shared_ptr<const Snapshot> snapshot() const {
+        std::lock_guard<std::mutex> lock(publishMutex);
+        return published;
+    }
+
+    // Публикация для читателей после пачки изменений; под блокировкой только замена указателя
+    void publish() {
+        auto next = std::make_shared<Snapshot>();
+        next->versionNumber = publishedVersion.load(std::memory_order_relaxed) + 1;
+        next->items = cols;
+        next->pool = names;
+        next->nameViews = names->allViews();
+        next->slotOf = slots;
+        next->index = grid;
+        next->priorityOrder.reserve(cols.size());
+        for (auto it = byPriority.rbegin(); it != byPriority.rend(); ++it) {
+            next->priorityOrder.push_back(*slots.find(it->second));
+        }
+        std::shared_ptr<const Snapshot> old;
+        {
+            std::lock_guard<std::mutex> lock(publishMutex);
+            old = std::move(published);
+            published = std::move(next);
+            publishedVersion.store(published->version(), std::memory_order_release);
+        }
+    }
+
+    ~TargetManager() {
+        if (journal.isOpen()) journal.sync();
+    }
+
+    // false - fsync журнала только в compact() и saveTargetsToFile()
+    void setJournalSync(bool everyRecord) { syncEveryRecord = everyRecord; }
+
+    // Идентификаторы уникальны: цель с уже известным id заменяется.
+    // false - приоритет NaN или бесконечность, список не изменен
+    bool addTarget(int id, const std::string& name, double x, double y, double z,
+        double priority, double distance) {
+        if (!applyAdd(id, name, x, y, z, priority, distance)) return false;
+        if (journal.isOpen()) {
+            std::string payload;
+            encodeTarget(payload, targetAt(*slots.find(id)));
+            appendJournal(OP_ADD, payload);
+        }
+        return true;
+    }
+
+    // Удаление за O(1): на место удаленной цели переносится последняя
+    bool removeTarget(int target_id) {
+        if (!applyRemove(target_id)) return false;
+        if (journal.isOpen()) {
+            std::string payload;
+            appendPod(payload, static_cast<int32_t>(target_id));
+            appendJournal(OP_REMOVE, payload);
+        }
+        return true;
+    }
+
+    // base.snap - снимок, base.journal - изменения после него. При ошибке
+    // состояние и открытый журнал остаются прежними
+    bool openJournal(const std::string& base = "targets") {
+        Columns savedCols = cols;
+        std::shared_ptr<StringPool> savedNames = names;
+        SpatialGrid savedGrid = grid;
+        IdSlotMap savedSlots = slots;
+        std::set<std::pair<double, int>> savedPriority = byPriority;
+        auto rollback = [&]() {
+            cols = std::move(savedCols);
+            names = std::move(savedNames);
+            grid = std::move(savedGrid);
+            slots = std::move(savedSlots);
+            byPriority = std::move(savedPriority);
+            return false;
+        };
+        clearAll();
+        size_t records = 0;
+
+        // Снимок: magic, число целей, длина и контрольная сумма данных, данные
+        MappedFile snapshot;
+        if (snapshot.open(base + ".snap")) {
+            const char* p = snapshot.data();
+            const char* end = p + snapshot.size();
+            uint32_t magic = 0, checksum = 0;
+            uint64_t count = 0, size = 0;
+            if (!readPod(p, end, magic) || magic != SNAPSHOT_MAGIC || !readPod(p, end, count) ||
+                !readPod(p, end, size) || !readPod(p, end, checksum) ||
+                static_cast<uint64_t>(end - p) != size || fnv32(p, size) != checksum) return rollback();
+            for (uint64_t i = 0; i < count; i++) {
+                if (!decodeAdd(p, end)) return rollback();
+            }
+            if (p != end) return rollback();
+        }
+
+        std::string journalPath = base + ".journal";
+        size_t validBytes = 0;
+        {
+            MappedFile log;
+            if (log.open(journalPath)) {
+                const char* begin = log.data();
+                const char* p = begin;
+                const char* end = p + log.size();
+                while (p < end) {
+                    uint8_t op;
+                    uint32_t size, checksum;
+                    const char* rec = p;
+                    if (!readPod(p, end, op) || !readPod(p, end, size) || !readPod(p, end, checksum) ||
+                        static_cast<size_t>(end - p) < size || fnv32(p, size) != checksum) break;
+                    const char* payload = p;
+                    const char* payloadEnd = p + size;
+                    bool ok = false;
+                    if (op == OP_ADD) {
+                        ok = decodeAdd(payload, payloadEnd);
+                    } else if (op == OP_REMOVE) {
+                        int32_t id;
+                        ok = readPod(payload, payloadEnd, id);
+                        if (ok) applyRemove(id);
+                    }
+                    if (!ok) { p = rec; break; }
+                    p = payloadEnd;
+                    records++;
+                    validBytes = static_cast<size_t>(p - begin);
+                }
+            }
+        }
+        AppendFile opened;
+        if (!opened.open(journalPath, false)) return rollback();
+        std::error_code ec;
+        std::filesystem::resize_file(journalPath, validBytes, ec);
+        if (ec || !opened.sync()) return rollback();
+        journal.swap(opened);
+        journalBase = base;
+        journalRecords = records;
+        return true;
+    }
+
+    // Новый снимок вместо журнала; снимок и каталог сбрасываются на диск до очистки журнала
+    bool compact() {
+        rebuildNames();
+        if (journalBase.empty()) return false;
+        std::string body;
+        for (size_t i = 0; i < cols.size(); i++) encodeTarget(body, targetAt(i));
+        std::string data;
+        appendPod(data, SNAPSHOT_MAGIC);
+        appendPod(data, static_cast<uint64_t>(cols.size()));
+        appendPod(data, static_cast<uint64_t>(body.size()));
+        appendPod(data, fnv32(body.data(), body.size()));
+        data += body;
+
+        std::string snapPath = journalBase + ".snap";
+        std::string tmpPath = snapPath + ".tmp";
+        std::error_code ec;
+        {
+            AppendFile out;
+            if (!out.open(tmpPath, true) || !out.append(data.data(), data.size()) || !out.sync()) {
+                out.close();
+                std::filesystem::remove(tmpPath, ec);
+                return false;
+            }
+        }
+        std::filesystem::rename(tmpPath, snapPath, ec);
+        if (ec || !AppendFile::syncDirectory(journalDirectory())) return false;
+        // Если сбой случится до очистки, повтор журнала поверх снимка даст то же состояние
+        AppendFile emptied;
+        if (!emptied.open(journalBase + ".journal", true) || !emptied.sync()) return false;
+        journal.swap(emptied);
+        journalRecords = 0;
+        return true;
+    }
+
+    void saveTargetsToFile() {
+        if (journal.isOpen()) {   // все изменения уже в журнале
+            journal.sync();
+            return;
+        }
+        std::ofstream file(filename);
+        for (size_t i = 0; i < cols.size(); i++) {
+            file << cols.id[i] << "," << names->get(cols.name[i]) << "," << cols.x[i] << "," << cols.y[i] << ","
+                << cols.z[i] << "," << cols.priority[i] << "," << cols.distance[i] << "\n";
+        }
+        file.close();
+    }
+
+    void loadTargetsFromFile() {
+        std::ifstream file(filename);
+        clearAll();
+        int id;
+        std::string name;
+        double x, y, z, pr, dist;
+        char comma;
+        while (file >> id >> comma && std::getline(file, name, ',') &&
+            file >> x >> comma >> y >> comma >> z >> comma >> pr >> comma >> dist) {
+            applyAdd(id, name, x, y, z, pr, dist);
+        }
+        file.close();
+        if (journal.isOpen()) compact();   // журнал не знает о замене всего списка
+    }
+
+    size_t size() const { return cols.size(); }
+    size_t nameCount() const { return names->size(); }
+
+    Target targetAt(size_t slot) const { return cols.at(slot, names->allViews()); }
+
+    std::optional<Target> findTarget(int id) const {
+        const uint32_t* slot = slots.find(id);
+        if (!slot) return std::nullopt;
+        return targetAt(*slot);
+    }
+
+    // k ближайших целей к произвольной точке (например, к текущему аппарату)
+    std::vector<SpatialGrid::Hit> nearest(size_t k, double x, double y, double z) const {
+        return grid.nearest(k, x, y, z);
+    }
+
+    std::vector<SpatialGrid::Hit> withinRadius(double x, double y, double z, double radius) const {
+        return grid.withinRadius(x, y, z, radius);
+    }
+
+    PriorityView getHighPriorityTargets(double min_priority) const {
+        auto bound = byPriority.lower_bound({ min_priority, INT_MIN });
+        return PriorityView(this, byPriority.crbegin(), std::set<std::pair<double, int>>::const_reverse_iterator(bound));
+    }
+
+    void sortByDistance() {
+        cols.permute(distanceSorter.sort(cols.distance.data(), cols.size()));
+        rebuildSlots();
+    }
+};
+
+struct TelemetryData {
+    double time, altitude, speed, heading, fuel;
+};
+
+// Заголовок файла телеметрии. Числа записаны в порядке байтов машины-писателя,
+// читатель сверяет его по endianTag и отказывается от чужого порядка.
+struct TelemetryFileHeader {
+    static constexpr char MAGIC[8] = { 'T', 'L', 'M', 'L', 'O', 'G', '\r', '\n' };
+    static constexpr uint16_t VERSION = 1;
+    static constexpr uint32_t ENDIAN_TAG = 0x01020304;
+    static constexpr const char* SCHEMA = "time,altitude,speed,heading,fuel";
+    static constexpr uint32_t ENCODING_RAW = 0;        // записи TelemetryData подряд
+    static constexpr uint32_t ENCODING_GORILLA = 1;    // сжатые блоки, см. GorillaCodec
+
+    char magic[8];
+    uint16_t version;
+    uint16_t headerSize;
+    uint32_t endianTag;
+    uint32_t recordSize;
+    uint32_t encoding;
+    uint64_t recordCount;
+    double timeMin, timeMax;
+    char schema[48];
+
+    static TelemetryFileHeader make(const TelemetryData* records, size_t count, uint32_t encoding = ENCODING_RAW) {
+        TelemetryFileHeader h{};
+        std::memcpy(h.magic, MAGIC, sizeof h.magic);
+        h.version = VERSION;
+        h.headerSize = sizeof(TelemetryFileHeader);
+        h.endianTag = ENDIAN_TAG;
+        h.recordSize = sizeof(TelemetryData);
+        h.encoding = encoding;
+        h.recordCount = count;
+        h.timeMin = count ? records[0].time : 0.0;
+        h.timeMax = h.timeMin;
+        for (size_t i = 1; i < count; i++) {
+            h.timeMin = std::min(h.timeMin, records[i].time);
+            h.timeMax = std::max(h.timeMax, records[i].time);
+        }
+        std::strncpy(h.schema, SCHEMA, sizeof h.schema - 1);
+        return h;
+    }
+
+    // Текст ошибки или nullptr, если файл указанного размера читается
+    const char* check(size_t fileSize) const {
+        if (endianTag != ENDIAN_TAG) return "чужой порядок байтов";
+        if (version != VERSION) return "неизвестная версия";
+        if (headerSize < sizeof(TelemetryFileHeader) || headerSize % alignof(TelemetryData) != 0) return "неверный размер заголовка";
+        if (recordSize != sizeof(TelemetryData)) return "неверный размер записи";
+        if (std::strncmp(schema, SCHEMA, sizeof schema) != 0) return "другая схема полей";
+        if (encoding != ENCODING_RAW && encoding != ENCODING_GORILLA) return "неизвестное кодирование";
+        if (fileSize < headerSize) return "файл обрезан";
+        if (encoding == ENCODING_RAW && recordCount > (fileSize - headerSize) / recordSize) return "файл обрезан";
+        return nullptr;
+    }
+};
+static_assert(sizeof(TelemetryFileHeader) == 96, "заголовок должен сохранять выравнивание записей");
+
+// Заголовок сжатого блока; за ним bytes байт битового потока (кратно 8)
+struct TelemetryBlockHeader {
+    static constexpr uint32_t FLAG_TICKS = 1;    // время хранится целыми микросекундами
+
+    uint32_t count;
+    uint32_t flags;
+    uint64_t bytes;
+    double timeMin, timeMax;
+};
+static_assert(sizeof(TelemetryBlockHeader) == 32, "блоки должны сохранять выравнивание");
+
+inline int leadingZeros64(uint64_t x) {
+#if defined(__GNUC__)
+    return x ? __builtin_clzll(x) : 64;
+#else
+    int n = 0;
+    for (uint64_t bit = 1ULL << 63; bit && !(x & bit); bit >>= 1) n++;
+    return n;
+#endif
+}
+
+inline int trailingZeros64(uint64_t x) {
+#if defined(__GNUC__)
+    return x ? __builtin_ctzll(x) : 64;
+#else
+    int n = 0;
+    for (uint64_t bit = 1; bit && !(x & bit); bit <<= 1) n++;
+    return n;
+#endif
+}
+
+inline int popCount64(uint64_t x) {
+#if defined(__GNUC__)
+    return __builtin_popcountll(x);
+#else
+    int n = 0;
+    for (; x; x &= x - 1) n++;
+    return n;
+#endif
+}
+
+// Битовый поток старшими битами вперед, слова по 64 бита
+class BitWriter {
+private:
+    std::vector<uint64_t> words;
+    int used = 64;      // занято битов в последнем слове
+
+public:
+    void write(uint64_t value, int bits) {
+        while (bits > 0) {
+            if (used == 64) {
+                words.push_back(0);
+                used = 0;
+            }
+            int take = std::min(bits, 64 - used);
+            uint64_t part = value >> (bits - take);
+            if (take < 64) part &= (1ULL << take) - 1;
+            words.back() |= part << (64 - used - take);
+            used += take;
+            bits -= take;
+        }
+    }
+
+    void clear() {
+        words.clear();
+        used = 64;
+    }
+
+    const std::vector<uint64_t>& data() const { return words; }
+};
+
+class BitReader {
+private:
+    const uint64_t* words;
+    size_t count;
+    size_t index = 0;
+    int pos = 0;
+    bool overrun = false;
+
+public:
+    BitReader(const uint64_t* w, size_t n) : words(w), count(n) {}
+
+    uint64_t read(int bits) {
+        uint64_t result = 0;
+        while (bits > 0) {
+            if (index >= count) {
+                overrun = true;
+                return 0;
+            }
+            int take = std::min(bits, 64 - pos);
+            uint64_t part = (words[index] << pos) >> (64 - take);
+            result = take == 64 ? part : (result << take) | part;
+            pos += take;
+            bits -= take;
+            if (pos == 64) {
+                pos = 0;
+                index++;
+            }
+        }
+        return result;
+    }
+
+    bool bit() { return read(1) != 0; }
+    bool failed() const { return overrun; }
+};
+
+// Сжатие блоков телеметрии по схеме Gorilla: время - разность разностей в
+// микросекундах, если блок в них точно укладывается, иначе XOR, как остальные поля
+class GorillaCodec {
+private:
+    struct XorState {
+        uint64_t prev = 0;
+        int lead = -1, trail = 0;
+    };
+
+    static uint64_t toBits(double v) {
+        uint64_t b;
+        std::memcpy(&b, &v, sizeof b);
+        return b;
+    }
+
+    static double fromBits(uint64_t b) {
+        double v;
+        std::memcpy(&v, &b, sizeof v);
+        return v;
+    }
+
+    // Сравнение битов, а не значений: иначе -0.0 превратился бы в 0.0
+    static bool toTicks(double t, int64_t& ticks) {
+        if (!(std::fabs(t) < 1e12)) return false;
+        ticks = std::llround(t * 1e6);
+        return toBits(static_cast<double>(ticks) / 1e6) == toBits(t);
+    }
+
+    static void putXor(BitWriter& w, XorState& st, double value) {
+        uint64_t bits = toBits(value);
+        uint64_t x = bits ^ st.prev;
+        st.prev = bits;
+        if (x == 0) {
+            w.write(0, 1);
+            return;
+        }
+        int lead = std::min(leadingZeros64(x), 31);
+        int trail = trailingZeros64(x);
+        if (st.lead >= 0 && lead >= st.lead && trail >= st.trail) {
+            w.write(2, 2);
+            w.write(x >> st.trail, 64 - st.lead - st.trail);
+        } else {
+            int len = 64 - lead - trail;
+            w.write(3, 2);
+            w.write(lead, 5);
+            w.write(len - 1, 6);
+            w.write(x >> trail, len);
+            st.lead = lead;
+            st.trail = trail;
+        }
+    }
+
+    static double getXor(BitReader& r, XorState& st) {
+        if (r.bit()) {
+            if (r.bit()) {
+                st.lead = static_cast<int>(r.read(5));
+                int len = static_cast<int>(r.read(6)) + 1;
+                st.trail = 64 - st.lead - len;
+                if (st.trail < 0) st.trail = 0;
+                st.prev ^= r.read(len) << st.trail;
+            } else {
+                st.prev ^= r.read(64 - st.lead - st.trail) << st.trail;
+            }
+        }
+        return fromBits(st.prev);
+    }
+
+    // Разность разностей: 0 -> '0', иначе префикс длины и zigzag-значение
+    static void putDod(BitWriter& w, int64_t dod) {
+        uint64_t zz = (static_cast<uint64_t>(dod) << 1) ^ static_cast<uint64_t>(dod >> 63);
+        if (zz == 0) w.write(0, 1);
+        else if (zz < (1ULL << 7)) { w.write(2, 2); w.write(zz, 7); }
+        else if (zz < (1ULL << 9)) { w.write(6, 3); w.write(zz, 9); }
+        else if (zz < (1ULL << 12)) { w.write(14, 4); w.write(zz, 12); }
+        else { w.write(15, 4); w.write(zz, 64); }
+    }
+
+    static int64_t getDod(BitReader& r) {
+        uint64_t zz;
+        if (!r.bit()) return 0;
+        if (!r.bit()) zz = r.read(7);
+        else if (!r.bit()) zz = r.read(9);
+        else if (!r.bit()) zz = r.read(12);
+        else zz = r.read(64);
+        return static_cast<int64_t>(zz >> 1) ^ -static_cast<int64_t>(zz & 1);
+    }
+
+public:
+    static constexpr size_t BLOCK_RECORDS = 256;
+
+    // Дописывает в out заголовок блока и сжатые записи
+    static void encodeBlock(const TelemetryData* records, size_t n, std::string& out, BitWriter& w) {
+        TelemetryBlockHeader bh{};
+        bh.count = static_cast<uint32_t>(n);
+        bh.timeMin = bh.timeMax = records[0].time;
+        bool ticks = true;
+        std::vector<int64_t> tickValues(n);
+        for (size_t i = 0; i < n; i++) {
+            bh.timeMin = std::min(bh.timeMin, records[i].time);
+            bh.timeMax = std::max(bh.timeMax, records[i].time);
+            if (ticks && !toTicks(records[i].time, tickValues[i])) ticks = false;
+        }
+        if (ticks) bh.flags |= TelemetryBlockHeader::FLAG_TICKS;
+
+        w.clear();
+        XorState timeState, alt, spd, hdg, fuel;
+        uint64_t prevTick = 0, prevDelta = 0;
+        for (size_t i = 0; i < n; i++) {
+            const TelemetryData& d = records[i];
+            if (ticks) {
+                uint64_t tick = static_cast<uint64_t>(tickValues[i]);
+                if (i == 0) {
+                    w.write(tick, 64);
+                } else {
+                    uint64_t delta = tick - prevTick;
+                    putDod(w, static_cast<int64_t>(delta - prevDelta));
+                    prevDelta = delta;
+                }
+                prevTick = tick;
+            } else {
+                putXor(w, timeState, d.time);
+            }
+            putXor(w, alt, d.altitude);
+            putXor(w, spd, d.speed);
+            putXor(w, hdg, d.heading);
+            putXor(w, fuel, d.fuel);
+        }
+        bh.bytes = w.data().size() * sizeof(uint64_t);
+        out.append(reinterpret_cast<const char*>(&bh), sizeof bh);
+        out.append(reinterpret_cast<const char*>(w.data().data()), static_cast<size_t>(bh.bytes));
+    }
+
+    // Дописывает записи блока в out; false - поток поврежден
+    static bool decodeBlock(const TelemetryBlockHeader& bh, std::vector<TelemetryData>& out) {
+        const uint64_t* words = reinterpret_cast<const uint64_t*>(&bh + 1);
+        BitReader r(words, static_cast<size_t>(bh.bytes / sizeof(uint64_t)));
+        bool ticks = (bh.flags & TelemetryBlockHeader::FLAG_TICKS) != 0;
+        size_t start = out.size();
+        out.resize(start + bh.count);
+        TelemetryData* dst = out.data() + start;
+        XorState timeState, alt, spd, hdg, fuel;
+        uint64_t tick = 0, delta = 0;
+        for (uint32_t i = 0; i < bh.count; i++) {
+            TelemetryData& d = dst[i];
+            if (ticks) {
+                if (i == 0) {
+                    tick = r.read(64);
+                } else {
+                    delta += static_cast<uint64_t>(getDod(r));
+                    tick += delta;
+                }
+                d.time = static_cast<double>(static_cast<int64_t>(tick)) / 1e6;
+            } else {
+                d.time = getXor(r, timeState);
+            }
+            d.altitude = getXor(r, alt);
+            d.speed = getXor(r, spd);
+            d.heading = getXor(r, hdg);
+            d.fuel = getXor(r, fuel);
+        }
+        if (r.failed()) {
+            out.resize(start);
+            return false;
+        }
+        return true;
+    }
+};
+
+// Непрерывный диапазон записей без владения памятью
+struct TelemetrySpan {
+    const TelemetryData* ptr = nullptr;
+    size_t count = 0;
+
+    const TelemetryData* begin() const { return ptr; }
+    const TelemetryData* end() const { return ptr + count; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    const TelemetryData& operator[](size_t i) const { return ptr[i]; }
+};
+
+// Файл телеметрии, отображенный в память; сжатые записи - через decodeBlock.
+// Старые файлы без заголовка открываются как есть (header() == nullptr)
+class TelemetryFile {
+private:
+    MappedFile file;
+    const TelemetryFileHeader* hdr = nullptr;
+    TelemetrySpan span;
+    std::vector<const TelemetryBlockHeader*> blocks;
+    std::string error;
+
+    // Проверяет цепочку сжатых блоков и запоминает их положение
+    const char* indexBlocks() {
+        const char* p = file.data() + hdr->headerSize;
+        const char* end = file.data() + file.size();
+        uint64_t total = 0;
+        while (p < end) {
+            if (static_cast<size_t>(end - p) < sizeof(TelemetryBlockHeader)) return "обрезан заголовок блока";
+            const auto* bh = reinterpret_cast<const TelemetryBlockHeader*>(p);
+            if (bh->count == 0 || bh->bytes % sizeof(uint64_t) != 0 ||
+                bh->bytes > static_cast<uint64_t>(end - p) - sizeof(TelemetryBlockHeader)) return "поврежден блок";
+            blocks.push_back(bh);
+            total += bh->count;
+            p += sizeof(TelemetryBlockHeader) + bh->bytes;
+        }
+        if (total != hdr->recordCount) return "число записей в блоках не совпадает с заголовком";
+        return nullptr;
+    }
+
+public:
+    bool open(const std::string& path) {
+        close();
+        if (!file.open(path)) {
+            error = "не удалось открыть " + path;
+            return false;
+        }
+        const char* base = file.data();
+        size_t size = file.size();
+        if (size >= sizeof(TelemetryFileHeader) &&
+            std::memcmp(base, TelemetryFileHeader::MAGIC, sizeof TelemetryFileHeader::MAGIC) == 0) {
+            const auto* h = reinterpret_cast<const TelemetryFileHeader*>(base);
+            if (const char* problem = h->check(size)) {
+                error = path + ": " + problem;
+                file.close();
+                return false;
+            }
+            hdr = h;
+            if (h->encoding == TelemetryFileHeader::ENCODING_GORILLA) {
+                if (const char* problem = indexBlocks()) {
+                    close();
+                    error = path + ": " + problem;
+                    return false;
+                }
+            } else {
+                span = { reinterpret_cast<const TelemetryData*>(base + h->headerSize), static_cast<size_t>(h->recordCount) };
+            }
+        } else {
+            span = { reinterpret_cast<const TelemetryData*>(base), size / sizeof(TelemetryData) };
+        }
+        return true;
+    }
+
+    void close() {
+        file.close();
+        hdr = nullptr;
+        span = {};
+        blocks.clear();
+        error.clear();
+    }
+
+    const TelemetryFileHeader* header() const { return hdr; }
+    size_t fileSize() const { return file.size(); }
+    bool compressed() const { return hdr && hdr->encoding == TelemetryFileHeader::ENCODING_GORILLA; }
+    // Записи без копирования; у сжатого файла пусто
+    TelemetrySpan records() const { return span; }
+    size_t blockCount() const { return blocks.size(); }
+    const TelemetryBlockHeader& block(size_t i) const { return *blocks[i]; }
+    bool decodeBlock(size_t i, std::vector<TelemetryData>& out) const { return GorillaCodec::decodeBlock(*blocks[i], out); }
+    const std::string& lastError() const { return error; }
+
+    // Все записи файла в out (с распаковкой, если нужно)
+    bool readAll(std::vector<TelemetryData>& out) const {
+        out.assign(span.begin(), span.end());
+        for (size_t i = 0; i < blocks.size(); i++) {
+            if (!decodeBlock(i, out)) return false;
+        }
+        return true;
+    }
+};
+
+// Все файлы ротации base_N.bin каталога в порядке N; итератор держит открытым
+// только текущий файл
+class TelemetryArchive {
+private:
+    std::vector<std::string> paths;
+    std::vector<long> numbers;
+
+public:
+    explicit TelemetryArchive(const std::string& baseFilename = "telemetry", const std::string& dir = ".") {
+        std::vector<std::pair<long, std::string>> found;
+        std::error_code ec;
+        std::string prefix = baseFilename + "_";
+        for (const auto& entry : std::filesystem::directory_iterator(dir, ec)) {
+            std::string name = entry.path().filename().string();
+            if (name.size() <= prefix.size() + 4 || name.compare(0, prefix.size(), prefix) != 0 ||
+                name.compare(name.size() - 4, 4, ".bin") != 0) continue;
+            std::string digits = name.substr(prefix.size(), name.size() - prefix.size() - 4);
+            if (digits.find_first_not_of("0123456789") != std::string::npos) continue;
+            found.push_back({ std::stol(digits), entry.path().string() });
+        }
+        std::sort(found.begin(), found.end());
+        for (auto& f : found) {
+            numbers.push_back(f.first);
+            paths.push_back(std::move(f.second));
+        }
+    }
+
+    size_t fileCount() const { return paths.size(); }
+    const std::string& path(size_t i) const { return paths[i]; }
+    long number(size_t i) const { return numbers[i]; }
+
+    class iterator {
+    private:
+        const TelemetryArchive* archive = nullptr;
+        size_t fileIndex = 0;
+        std::unique_ptr<TelemetryFile> current;
+        std::vector<TelemetryData> decoded;     // распакованный сжатый файл
+        TelemetrySpan span;
+        size_t pos = 0;
+
+        // Открывает следующий непустой читаемый файл, начиная с fileIndex
+        void settle() {
+            while (pos >= span.size() && fileIndex < archive->paths.size()) {
+                if (!current) current = std::make_unique<TelemetryFile>();
+                if (current->open(archive->paths[fileIndex])) {
+                    if (current->compressed()) {
+                        if (!current->readAll(decoded)) decoded.clear();
+                        span = { decoded.data(), decoded.size() };
+                    } else {
+                        span = current->records();
+                    }
+                    pos = 0;
+                    if (!span.empty()) return;
+                }
+                fileIndex++;
+            }
+            if (fileIndex >= archive->paths.size()) {
+                if (current) current->close();
+                span = {};
+                pos = 0;
+            }
+        }
+
+    public:
+        iterator(const TelemetryArchive* a, size_t index) : archive(a), fileIndex(index) {
+            if (fileIndex < archive->paths.size()) settle();
+        }
+
+        const TelemetryData& operator*() const { return span[pos]; }
+        const TelemetryData* operator->() const { return &span[pos]; }
+        iterator& operator++() {
+            if (++pos >= span.size()) {
+                fileIndex++;
+                settle();
+            }
+            return *this;
+        }
+        bool operator!=(const iterator& other) const { return fileIndex != other.fileIndex || pos != other.pos; }
+        bool operator==(const iterator& other) const { return !(*this != other); }
+        size_t file() const { return fileIndex; }
+    };
+
+    iterator begin() const { return iterator(this, 0); }
+    iterator end() const { return iterator(this, paths.size()); }
+};
+
+// Каталог base.catalog: при ротации дописывается запись о файле и индекс его
+// блоков по BLOCK_RECORDS записей. Для номера файла действует последняя запись.
+struct TelemetryCatalog {
+    static constexpr uint32_t ENTRY_MAGIC = 0x32434154;   // "TAC2"
+    static constexpr size_t BLOCK_RECORDS = 256;
+
+    struct FileEntry {
+        uint32_t magic;
+        uint32_t fileNumber;
+        uint32_t encoding;
+        uint32_t blockCount;
+        uint64_t recordCount;
+        double timeMin, timeMax;
+        uint64_t fileBytes;     // размер и время изменения файла при записи в каталог
+        int64_t modified;
+    };
+
+    // Размер и время изменения файла; false - файла нет
+    static bool stamp(const std::string& filePath, uint64_t& bytes, int64_t& modified) {
+        std::error_code ec;
+        bytes = std::filesystem::file_size(filePath, ec);
+        if (ec) return false;
+        auto time = std::filesystem::last_write_time(filePath, ec);
+        if (ec) return false;
+        modified = static_cast<int64_t>(time.time_since_epoch().count());
+        return true;
+    }
+
+    struct BlockEntry {
+        uint64_t offset;        // от начала файла: первая запись или заголовок сжатого блока
+        uint32_t count;
+        uint32_t reserved;
+        double timeMin, timeMax;
+    };
+
+    static std::string path(const std::string& baseFilename) { return baseFilename + ".catalog"; }
+};
+
+// Поиск по интервалу времени через каталог; файлы не из каталога или
+// измененные после записи в него индексируются по содержимому
+class TelemetryIndex {
+private:
+    struct FileInfo {
+        std::string path;
+        uint32_t encoding;
+        uint64_t recordCount;
+        double timeMin, timeMax;
+        uint64_t fileBytes;
+        std::vector<TelemetryCatalog::BlockEntry> blocks;
+    };
+    std::vector<FileInfo> files;          // по возрастанию timeMin
+    std::vector<double> maxTimeUpTo;      // максимум timeMax среди files[0..i]
+
+    static void indexFromContents(const TelemetryFile& tf, FileInfo& info) {
+        const TelemetryFileHeader* h = tf.header();
+        info.encoding = h ? h->encoding : TelemetryFileHeader::ENCODING_RAW;
+        info.fileBytes = tf.fileSize();
+        info.recordCount = 0;
+        info.timeMin = std::numeric_limits<double>::infinity();
+        info.timeMax = -std::numeric_limits<double>::infinity();
+        if (tf.compressed()) {
+            for (size_t b = 0; b < tf.blockCount(); b++) {
+                const TelemetryBlockHeader& bh = tf.block(b);
+                uint64_t offset = static_cast<uint64_t>(reinterpret_cast<const char*>(&bh) - reinterpret_cast<const char*>(h));
+                info.blocks.push_back({ offset, bh.count, 0, bh.timeMin, bh.timeMax });
+            }
+        } else {
+            TelemetrySpan r = tf.records();
+            uint64_t base = h ? h->headerSize : 0;
+            for (size_t i = 0; i < r.size(); i += TelemetryCatalog::BLOCK_RECORDS) {
+                size_t n = std::min(TelemetryCatalog::BLOCK_RECORDS, r.size() - i);
+                TelemetryCatalog::BlockEntry be{ base + i * sizeof(TelemetryData), static_cast<uint32_t>(n), 0, r[i].time, r[i].time };
+                for (size_t k = i; k < i + n; k++) {
+                    be.timeMin = std::min(be.timeMin, r[k].time);
+                    be.timeMax = std::max(be.timeMax, r[k].time);
+                }
+                info.blocks.push_back(be);
+            }
+        }
+        for (const auto& b : info.blocks) {
+            info.recordCount += b.count;
+            info.timeMin = std::min(info.timeMin, b.timeMin);
+            info.timeMax = std::max(info.timeMax, b.timeMax);
+        }
+    }
+
+public:
+    explicit TelemetryIndex(const std::string& baseFilename = "telemetry", const std::string& dir = ".") {
+        TelemetryArchive archive(baseFilename, dir);
+        std::unordered_map<long, std::pair<int64_t, FileInfo>> catalogued;   // номер -> (время изменения, описание)
+        MappedFile catalog;
+        if (catalog.open((std::filesystem::path(dir) / TelemetryCatalog::path(baseFilename)).string())) {
+            const char* p = catalog.data();
+            const char* end = p + catalog.size();
+            TelemetryCatalog::FileEntry fe;
+            // Обрезанная последняя запись (сбой во время дописывания) отбрасывается
+            while (static_cast<size_t>(end - p) >= sizeof fe) {
+                std::memcpy(&fe, p, sizeof fe);
+                size_t blockBytes = static_cast<size_t>(fe.blockCount) * sizeof(TelemetryCatalog::BlockEntry);
+                if (fe.magic != TelemetryCatalog::ENTRY_MAGIC || static_cast<size_t>(end - p) - sizeof fe < blockBytes) break;
+                p += sizeof fe;
+                FileInfo info{ {}, fe.encoding, fe.recordCount, fe.timeMin, fe.timeMax, fe.fileBytes, {} };
+                info.blocks.resize(fe.blockCount);
+                if (blockBytes) std::memcpy(info.blocks.data(), p, blockBytes);
+                p += blockBytes;
+                catalogued[fe.fileNumber] = { fe.modified, std::move(info) };
+            }
+        }
+
+        for (size_t i = 0; i < archive.fileCount(); i++) {
+            auto it = catalogued.find(archive.number(i));
+            uint64_t bytes = 0;
+            int64_t modified = 0;
+            bool stamped = TelemetryCatalog::stamp(archive.path(i), bytes, modified);
+            FileInfo info;
+            if (it != catalogued.end() && stamped && it->second.second.fileBytes == bytes && it->second.first == modified) {
+                info = std::move(it->second.second);
+            } else {
+                TelemetryFile tf;
+                if (!tf.open(archive.path(i))) continue;
+                indexFromContents(tf, info);
+            }
+            if (info.recordCount == 0) continue;
+            info.path = archive.path(i);
+            files.push_back(std::move(info));
+        }
+        std::sort(files.begin(), files.end(),
+            [](const FileInfo& a, const FileInfo& b) { return a.timeMin < b.timeMin; });
+        maxTimeUpTo.resize(files.size());
+        for (size_t i = 0; i < files.size(); i++) {
+            maxTimeUpTo[i] = i ? std::max(maxTimeUpTo[i - 1], files[i].timeMax) : files[i].timeMax;
+        }
+    }
+
+    size_t fileCount() const { return files.size(); }
+
+    // Вызывает visit(const TelemetryData&) для каждой записи с t0 <= time <= t1,
+    // возвращает число открытых файлов
+    template <typename Visitor>
+    size_t query(double t0, double t1, Visitor&& visit) const {
+        // Кандидаты: timeMin <= t1; с конца, пока накопленный максимум timeMax >= t0
+        size_t hi = static_cast<size_t>(std::upper_bound(files.begin(), files.end(), t1,
+            [](double t, const FileInfo& f) { return t < f.timeMin; }) - files.begin());
+        size_t opened = 0;
+        std::vector<TelemetryData> decoded;
+        TelemetryFile tf;
+        for (size_t i = hi; i-- > 0 && maxTimeUpTo[i] >= t0;) {
+            const FileInfo& info = files[i];
+            if (info.timeMax < t0) continue;
+            if (!tf.open(info.path)) continue;
+            opened++;
+            const char* base = reinterpret_cast<const char*>(tf.header());
+            TelemetrySpan raw = tf.records();
+            // Файл переписан после построения индекса - блоки ищутся заново
+            const std::vector<TelemetryCatalog::BlockEntry>* blocks = &info.blocks;
+            FileInfo fresh;
+            if (tf.fileSize() != info.fileBytes || (tf.header() && tf.header()->recordCount != info.recordCount)) {
+                indexFromContents(tf, fresh);
+                blocks = &fresh.blocks;
+            }
+            for (const auto& b : *blocks) {
+                if (b.timeMax < t0 || b.timeMin > t1) continue;
+                const TelemetryData* first;
+                size_t count;
+                if (tf.compressed()) {
+                    // Смещение из каталога сверяется с проверенной цепочкой блоков
+                    size_t k = 0;
+                    while (k < tf.blockCount() && reinterpret_cast<const char*>(&tf.block(k)) - base != static_cast<ptrdiff_t>(b.offset)) k++;
+                    if (k == tf.blockCount()) continue;
+                    decoded.clear();
+                    if (!tf.decodeBlock(k, decoded)) continue;
+                    first = decoded.data();
+                    count = decoded.size();
+                } else {
+                    uint64_t headerSize = tf.header() ? tf.header()->headerSize : 0;
+                    uint64_t start = (b.offset - headerSize) / sizeof(TelemetryData);
+                    if (b.offset < headerSize || start >= raw.size()) continue;
+                    first = raw.begin() + start;
+                    count = std::min<size_t>(b.count, raw.size() - start);
+                }
+                for (size_t k = 0; k < count; k++) {
+                    if (first[k].time >= t0 && first[k].time <= t1) visit(first[k]);
+                }
+            }
+        }
+        return opened;
+    }
+
+    std::vector<TelemetryData> range(double t0, double t1) const {
+        std::vector<TelemetryData> result;
+        query(t0, t1, [&result](const TelemetryData& d) { result.push_back(d); });
+        std::stable_sort(result.begin(), result.end(),
+            [](const TelemetryData& a, const TelemetryData& b) { return a.time < b.time; });
+        return result;
+    }
+};
+
+// Агрегат по интервалу времени для altitude, speed, heading, fuel (в этом порядке)
+struct TelemetryRollupBucket {
+    static constexpr int FIELDS = 4;
+
+    double start;
+    uint64_t count;
+    double lastTime;
+    double min[FIELDS], max[FIELDS], mean[FIELDS], last[FIELDS];
+
+    static TelemetryRollupBucket empty(double bucketStart) {
+        TelemetryRollupBucket b{};
+        b.start = bucketStart;
+        b.lastTime = -std::numeric_limits<double>::infinity();
+        for (int f = 0; f < FIELDS; f++) {
+            b.min[f] = std::numeric_limits<double>::infinity();
+            b.max[f] = -std::numeric_limits<double>::infinity();
+        }
+        return b;
+    }
+
+    void add(const TelemetryData& d) {
+        const double v[FIELDS] = { d.altitude, d.speed, d.heading, d.fuel };
+        count++;
+        bool latest = d.time >= lastTime;
+        if (latest) lastTime = d.time;
+        for (int f = 0; f < FIELDS; f++) {
+            min[f] = std::min(min[f], v[f]);
+            max[f] = std::max(max[f], v[f]);
+            mean[f] += (v[f] - mean[f]) / count;
+            if (latest) last[f] = v[f];
+        }
+    }
+
+    void merge(const TelemetryRollupBucket& o) {
+        if (o.count == 0) return;
+        uint64_t total = count + o.count;
+        bool latest = o.lastTime >= lastTime;
+        for (int f = 0; f < FIELDS; f++) {
+            min[f] = std::min(min[f], o.min[f]);
+            max[f] = std::max(max[f], o.max[f]);
+            mean[f] = (mean[f] * count + o.mean[f] * o.count) / total;
+            if (latest) last[f] = o.last[f];
+        }
+        if (latest) lastTime = o.lastTime;
+        count = total;
+    }
+};
+
+// Агрегаты base_N.rollup рядом с файлом данных: интервалы 1 с, 10 с и 1 мин;
+// неполные интервалы на границах файлов объединяются при чтении
+struct TelemetryRollupHeader {
+    static constexpr char MAGIC[8] = { 'T', 'L', 'M', 'R', 'O', 'L', '\r', '\n' };
+    static constexpr uint16_t VERSION = 1;
+    static constexpr int LEVELS = 3;
+    static constexpr double WIDTHS[LEVELS] = { 1.0, 10.0, 60.0 };
+
+    char magic[8];
+    uint16_t version;
+    uint16_t levelCount;
+    uint32_t endianTag;
+    uint32_t bucketSize;
+    uint32_t counts[LEVELS];
+    double widths[LEVELS];
+
+    static std::string pathFor(const std::string& dataPath) {
+        std::string p = dataPath;
+        if (p.size() >= 4 && p.compare(p.size() - 4, 4, ".bin") == 0) p.resize(p.size() - 4);
+        return p + ".rollup";
+    }
+
+    // Строит агрегаты всех уровней для записей одного файла
+    static void build(const std::vector<TelemetryData>& records, std::vector<TelemetryRollupBucket> (&levels)[LEVELS]) {
+        for (int l = 0; l < LEVELS; l++) {
+            levels[l].clear();
+            std::map<int64_t, TelemetryRollupBucket> buckets;
+            for (const auto& d : records) {
+                if (!std::isfinite(d.time)) continue;
+                int64_t key = static_cast<int64_t>(std::floor(d.time / WIDTHS[l]));
+                auto it = buckets.find(key);
+                if (it == buckets.end()) it = buckets.emplace(key, TelemetryRollupBucket::empty(key * WIDTHS[l])).first;
+                it->second.add(d);
+            }
+            for (const auto& b : buckets) levels[l].push_back(b.second);
+        }
+    }
+};
+static_assert(sizeof(TelemetryRollupHeader) % 8 == 0, "интервалы должны быть выровнены");
+
+// Агрегаты всех файлов ротации; исходные записи не читаются
+class TelemetryRollups {
+private:
+    std::vector<std::string> paths;
+
+public:
+    enum Level { Second = 0, TenSeconds = 1, Minute = 2 };
+
+    explicit TelemetryRollups(const std::string& baseFilename = "telemetry", const std::string& dir = ".") {
+        TelemetryArchive archive(baseFilename, dir);
+        for (size_t i = 0; i < archive.fileCount(); i++) {
+            std::string p = TelemetryRollupHeader::pathFor(archive.path(i));
+            if (std::filesystem::exists(p)) paths.push_back(p);
+        }
+    }
+
+    size_t fileCount() const { return paths.size(); }
+
+    // Объединенные интервалы уровня level, начинающиеся в [t0, t1], по возрастанию времени
+    std::vector<TelemetryRollupBucket> buckets(Level level, double t0, double t1) const {
+        std::map<double, TelemetryRollupBucket> merged;
+        MappedFile file;
+        for (const auto& p : paths) {
+            if (!file.open(p) || file.size() < sizeof(TelemetryRollupHeader)) continue;
+            TelemetryRollupHeader h;
+            std::memcpy(&h, file.data(), sizeof h);
+            if (std::memcmp(h.magic, TelemetryRollupHeader::MAGIC, sizeof h.magic) != 0 ||
+                h.version != TelemetryRollupHeader::VERSION || h.endianTag != TelemetryFileHeader::ENDIAN_TAG ||
+                h.bucketSize != sizeof(TelemetryRollupBucket) || h.levelCount != TelemetryRollupHeader::LEVELS) continue;
+            size_t offset = sizeof h;
+            for (int l = 0; l < level; l++) offset += h.counts[l] * sizeof(TelemetryRollupBucket);
+            if (offset + h.counts[level] * sizeof(TelemetryRollupBucket) > file.size()) continue;
+            const char* p0 = file.data() + offset;
+            for (uint32_t i = 0; i < h.counts[level]; i++) {
+                TelemetryRollupBucket b;
+                std::memcpy(&b, p0 + i * sizeof b, sizeof b);
+                if (b.start < t0 || b.start > t1) continue;
+                auto it = merged.find(b.start);
+                if (it == merged.end()) merged.emplace(b.start, b);
+                else it->second.merge(b);
+            }
+        }
+        std::vector<TelemetryRollupBucket> result;
+        result.reserve(merged.size());
+        for (const auto& m : merged) result.push_back(m.second);
+        return result;
+    }
+
+    // Один агрегат за весь промежуток по минутным интервалам
+    TelemetryRollupBucket total(double t0, double t1) const {
+        TelemetryRollupBucket sum = TelemetryRollupBucket::empty(t0);
+        for (const auto& b : buckets(Minute, t0, t1)) sum.merge(b);
+        return sum;
+    }
+};
+
+// Среднее и дисперсия по Велфорду: устойчиво к большим смещениям значений,
+// части, посчитанные в разных потоках, объединяются без потери точности
+struct RunningStats {
+    uint64_t count = 0;
+    double mean = 0.0, m2 = 0.0;
+    double min = std::numeric_limits<double>::infinity();
+    double max = -std::numeric_limits<double>::infinity();
+
+    void add(double x) {
+        count++;
+        double delta = x - mean;
+        mean += delta / count;
+        m2 += delta * (x - mean);
+        min = std::min(min, x);
+        max = std::max(max, x);
+    }
+
+    void merge(const RunningStats& o) {
+        if (o.count == 0) return;
+        if (count == 0) {
+            *this = o;
+            return;
+        }
+        uint64_t total = count + o.count;
+        double delta = o.mean - mean;
+        mean += delta * o.count / total;
+        m2 += o.m2 + delta * delta * (static_cast<double>(count) * o.count / total);
+        count = total;
+        min = std::min(min, o.min);
+        max = std::max(max, o.max);
+    }
+
+    double variance() const { return count > 1 ? m2 / (count - 1) : 0.0; }
+    double stddev() const { return std::sqrt(variance()); }
+};
+
+// Сводка по телеметрии: все файлы ротации читаются параллельно, по файлу
+// на задачу, частичные сводки потоков объединяются
+struct TelemetrySummary {
+    uint64_t records = 0;
+    size_t files = 0, unreadable = 0;
+    double timeMin = std::numeric_limits<double>::infinity();
+    double timeMax = -std::numeric_limits<double>::infinity();
+    RunningStats altitude, speed, heading, fuel;
+
+    void add(const TelemetryData& d) {
+        records++;
+        timeMin = std::min(timeMin, d.time);
+        timeMax = std::max(timeMax, d.time);
+        altitude.add(d.altitude);
+        speed.add(d.speed);
+        heading.add(d.heading);
+        fuel.add(d.fuel);
+    }
+
+    void merge(const TelemetrySummary& o) {
+        records += o.records;
+        files += o.files;
+        unreadable += o.unreadable;
+        timeMin = std::min(timeMin, o.timeMin);
+        timeMax = std::max(timeMax, o.timeMax);
+        altitude.merge(o.altitude);
+        speed.merge(o.speed);
+        heading.merge(o.heading);
+        fuel.merge(o.fuel);
+    }
+
+    double duration() const { return records ? timeMax - timeMin : 0.0; }
+
+    static TelemetrySummary collect(const TelemetryArchive& archive, unsigned threads = 0) {
+        if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+        threads = static_cast<unsigned>(std::min<size_t>(threads, std::max<size_t>(1, archive.fileCount())));
+        std::vector<TelemetrySummary> partial(threads);
+        std::atomic<size_t> nextFile{ 0 };
+        auto work = [&archive, &nextFile](TelemetrySummary& out) {
+            TelemetryFile file;
+            std::vector<TelemetryData> decoded;
+            for (size_t i; (i = nextFile.fetch_add(1)) < archive.fileCount();) {
+                if (!file.open(archive.path(i))) {
+                    out.unreadable++;
+                    continue;
+                }
+                TelemetrySpan records = file.records();
+                if (file.compressed()) {
+                    if (!file.readAll(decoded)) {
+                        out.unreadable++;
+                        continue;
+                    }
+                    records = { decoded.data(), decoded.size() };
+                }
+                out.files++;
+                for (const auto& d : records) out.add(d);
+            }
+        };
+        std::vector<std::thread> workers;
+        for (unsigned t = 1; t < threads; t++) workers.emplace_back(work, std::ref(partial[t]));
+        work(partial[0]);
+        for (auto& w : workers) w.join();
+        for (unsigned t = 1; t < threads; t++) partial[0].merge(partial[t]);
+        return partial[0];
+    }
+
+    void print(std::ostream& out) const {
+        out << "Entries: " << records << " in " << files << " files";
+        if (unreadable) out << " (" << unreadable << " unreadable)";
+        out << "\n";
+        if (records == 0) return;
+        out << "Time span: " << timeMin << " .. " << timeMax << " (" << duration() << " s)\n";
+        out << "Avg Altitude: " << altitude.mean << " (sd " << altitude.stddev() << ", " << altitude.min << " .. " << altitude.max << ")\n";
+        out << "Avg Speed: " << speed.mean << " (sd " << speed.stddev() << ", " << speed.min << " .. " << speed.max << ")\n";
+        out << "Fuel: " << fuel.max << " .. " << fuel.min << "\n";
+    }
+};
+
+#ifndef _WIN32
+// Последние capacity записей телеметрии в разделяемой памяти POSIX. У ячейки
+// свой счетчик (seqlock): нечетный - запись идет, 2n+2 - в ячейке запись номер n
+struct LiveTelemetryLayout {
+    static constexpr char MAGIC[8] = { 'T', 'L', 'M', 'L', 'I', 'V', 'E', '1' };
+
+    struct Header {
+        char magic[8];
+        uint32_t capacity;
+        uint32_t recordSize;
+        alignas(64) std::atomic<uint64_t> published;    // сколько записей опубликовано всего
+    };
+
+    struct Slot {
+        std::atomic<uint64_t> sequence;
+        TelemetryData data;
+    };
+
+    static size_t bytes(size_t capacity) { return sizeof(Header) + capacity * sizeof(Slot); }
+    static std::string shmName(const std::string& name) { return name.empty() || name[0] != '/' ? "/" + name : name; }
+};
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "счетчики в разделяемой памяти должны быть без блокировок");
+
+// Писатель держит flock на сегменте, второй с тем же именем не откроется.
+// Сегмент упавшего писателя продолжается при той же емкости, иначе заменяется
+class LiveTelemetryRing {
+private:
+    std::string name;
+    int fd = -1;
+    LiveTelemetryLayout::Header* header = nullptr;
+    LiveTelemetryLayout::Slot* slots = nullptr;
+    size_t mapped = 0;
+    uint64_t next = 0;
+
+    // Оставшийся сегмент подходит, если он целиком создан и той же емкости
+    bool reuse(size_t capacity) {
+        struct stat st;
+        size_t size = LiveTelemetryLayout::bytes(capacity);
+        if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) != size) return false;
+        void* p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (p == MAP_FAILED) return false;
+        auto* h = static_cast<LiveTelemetryLayout::Header*>(p);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (std::memcmp(h->magic, LiveTelemetryLayout::MAGIC, sizeof h->magic) != 0 ||
+            h->capacity != capacity || h->recordSize != sizeof(TelemetryData)) {
+            munmap(p, size);
+            return false;
+        }
+        header = h;
+        mapped = size;
+        slots = reinterpret_cast<LiveTelemetryLayout::Slot*>(static_cast<char*>(p) + sizeof(LiveTelemetryLayout::Header));
+        next = header->published.load(std::memory_order_relaxed);
+        return true;
+    }
+
+    bool create(size_t capacity) {
+        size_t size = LiveTelemetryLayout::bytes(capacity);
+        if (ftruncate(fd, static_cast<off_t>(size)) != 0) return false;
+        void* p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (p == MAP_FAILED) return false;
+        mapped = size;
+        header = new (p) LiveTelemetryLayout::Header{};
+        slots = reinterpret_cast<LiveTelemetryLayout::Slot*>(static_cast<char*>(p) + sizeof(LiveTelemetryLayout::Header));
+        for (size_t i = 0; i < capacity; i++) new (&slots[i]) LiveTelemetryLayout::Slot{};
+        header->capacity = static_cast<uint32_t>(capacity);
+        header->recordSize = sizeof(TelemetryData);
+        // magic последним: читатель не примет наполовину созданный сегмент
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(header->magic, LiveTelemetryLayout::MAGIC, sizeof header->magic);
+        return true;
+    }
+
+    void closeFd() {
+        if (fd >= 0) ::close(fd);
+        fd = -1;
+    }
+
+public:
+    LiveTelemetryRing(const std::string& shmName, size_t capacity) : name(LiveTelemetryLayout::shmName(shmName)) {
+        if (capacity == 0 || capacity > UINT32_MAX) return;
+        for (int attempt = 0; attempt < 2 && !header; attempt++) {
+            bool created = true;
+            fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+            if (fd < 0 && errno == EEXIST) {
+                created = false;
+                fd = shm_open(name.c_str(), O_RDWR, 0);
+            }
+            if (fd < 0) return;
+            if (flock(fd, LOCK_EX | LOCK_NB) != 0) {   // у сегмента есть живой писатель
+                closeFd();
+                return;
+            }
+            if (created ? create(capacity) : reuse(capacity)) return;
+            // Чужой формат или емкость: имя отдается новому сегменту, старый живет, пока отображен
+            closeFd();
+            shm_unlink(name.c_str());
+            if (created) return;
+        }
+    }
+
+    ~LiveTelemetryRing() {
+        if (!header) return;
+        munmap(header, mapped);
+        shm_unlink(name.c_str());
+        closeFd();
+    }
+
+    LiveTelemetryRing(const LiveTelemetryRing&) = delete;
+    LiveTelemetryRing& operator=(const LiveTelemetryRing&) = delete;
+
+    bool isOpen() const { return header != nullptr; }
+
+    void publish(const TelemetryData& d) {
+        LiveTelemetryLayout::Slot& slot = slots[next % header->capacity];
+        slot.sequence.store(2 * next + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(&slot.data, &d, sizeof d);
+        slot.sequence.store(2 * next + 2, std::memory_order_release);
+        header->published.store(++next, std::memory_order_release);
+    }
+};
+
+// Читатель живой телеметрии из другого процесса (или потока)
+class LiveTelemetryReader {
+private:
+    const LiveTelemetryLayout::Header* header = nullptr;
+    const LiveTelemetryLayout::Slot* slots = nullptr;
+    size_t mapped = 0;
+
+public:
+    explicit LiveTelemetryReader(const std::string& shmName) {
+        int fd = shm_open(LiveTelemetryLayout::shmName(shmName).c_str(), O_RDONLY, 0);
+        if (fd < 0) return;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(LiveTelemetryLayout::Header)) {
+            ::close(fd);
+            return;
+        }
+        void* p = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) return;
+        const auto* h = static_cast<const LiveTelemetryLayout::Header*>(p);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (std::memcmp(h->magic, LiveTelemetryLayout::MAGIC, sizeof h->magic) != 0 ||
+            h->recordSize != sizeof(TelemetryData) || h->capacity == 0 ||
+            LiveTelemetryLayout::bytes(h->capacity) > static_cast<size_t>(st.st_size)) {
+            munmap(p, static_cast<size_t>(st.st_size));
+            return;
+        }
+        header = h;
+        mapped = static_cast<size_t>(st.st_size);
+        slots = reinterpret_cast<const LiveTelemetryLayout::Slot*>(static_cast<const char*>(p) + sizeof(LiveTelemetryLayout::Header));
+    }
+
+    ~LiveTelemetryReader() {
+        if (header) munmap(const_cast<LiveTelemetryLayout::Header*>(header), mapped);
+    }
+
+    LiveTelemetryReader(const LiveTelemetryReader&) = delete;
+    LiveTelemetryReader& operator=(const LiveTelemetryReader&) = delete;
+
+    bool isOpen() const { return header != nullptr; }
+    size_t capacity() const { return header ? header->capacity : 0; }
+    uint64_t published() const { return header ? header->published.load(std::memory_order_acquire) : 0; }
+
+    // Запись номер n; false - еще не опубликована или уже перезаписана
+    bool read(uint64_t n, TelemetryData& out) const {
+        if (!header) return false;
+        const LiveTelemetryLayout::Slot& slot = slots[n % header->capacity];
+        uint64_t before = slot.sequence.load(std::memory_order_acquire);
+        if (before != 2 * n + 2) return false;
+        std::memcpy(&out, &slot.data, sizeof out);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return slot.sequence.load(std::memory_order_relaxed) == before;
+    }
+
+    bool latest(TelemetryData& out) const {
+        uint64_t n = published();
+        return n > 0 && read(n - 1, out);
+    }
+
+    // Все записи после cursor (номер следующей ожидаемой); cursor продвигается.
+    // Возвращает число пропущенных записей, если читатель отстал больше чем на capacity.
+    uint64_t readSince(uint64_t& cursor, std::vector<TelemetryData>& out) const {
+        uint64_t end = published();
+        uint64_t lost = 0;
+        if (end > cursor + capacity()) {
+            lost = end - capacity() - cursor;
+            cursor = end - capacity();
+        }
+        TelemetryData d;
+        for (; cursor < end; cursor++) {
+            if (read(cursor, d)) out.push_back(d);
+            else lost++;
+        }
+        return lost;
+    }
+};
+#endif
+
+// Ограниченная очередь "много писателей - один читатель" без блокировок (схема Вьюкова)
+template <typename T>
+class MpscRing {
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+    std::unique_ptr<Cell[]> cells;
+    size_t mask;
+    alignas(64) std::atomic<size_t> enqueuePos{ 0 };
+    alignas(64) size_t dequeuePos = 0;
+
+public:
+    explicit MpscRing(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity) size <<= 1;
+        mask = size - 1;
+        cells.reset(new Cell[size]);
+        for (size_t i = 0; i < size; i++) cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    size_t capacity() const { return mask + 1; }
+
+    // Вызывается из любого потока; false - очередь заполнена
+    bool tryPush(const T& value) {
+        size_t pos = enqueuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells[pos & mask];
+            size_t seq = cell.sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.value = value;
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Только из потока-читателя
+    bool tryPop(T& out) {
+        Cell& cell = cells[dequeuePos & mask];
+        size_t seq = cell.sequence.load(std::memory_order_acquire);
+        if (static_cast<intptr_t>(seq) - static_cast<intptr_t>(dequeuePos + 1) < 0) return false;
+        out = cell.value;
+        cell.sequence.store(dequeuePos + mask + 1, std::memory_order_release);
+        dequeuePos++;
+        return true;
+    }
+};
+
+// Запись телеметрии: producers кладут записи в MpscRing и никогда не ждут диск,
+// фоновый поток собирает их пачками по maxEntries и пишет файлы с ротацией.
+class TelemetryLogger {
+private:
+    std::string baseFilename = "telemetry";
+    int fileCounter = 1;
+    const size_t maxEntries = 1000;
+    MpscRing<TelemetryData> ring;
+    std::vector<TelemetryData> buffer;            // текущая пачка, принадлежит писателю
+    mutable std::mutex bufferMutex;               // только писатель и printLogSummary
+    std::atomic<uint64_t> dropped{ 0 };
+    std::atomic<uint64_t> flushRequested{ 0 };
+    std::atomic<uint64_t> flushDone{ 0 };
+    std::atomic<uint64_t> syncRequested{ 0 };      // дождаться записей в полете без ротации
+    std::atomic<uint64_t> syncDone{ 0 };
+    std::atomic<bool> running{ true };
+    std::atomic<bool> compress{ false };
+    std::atomic<int> syncPolicy{ static_cast<int>(AsyncFileWriter::SyncPolicy::None) };
+    std::string encoded;                          // буферы сжатия, только писатель
+    BitWriter bits;
+    std::vector<TelemetryCatalog::BlockEntry> blockIndex;
+    std::ofstream catalog;                        // base.catalog, дописывается при ротации
+    std::vector<TelemetryRollupBucket> rollupLevels[TelemetryRollupHeader::LEVELS];
+    AsyncFileWriter io;                           // после catalog: при разрушении его колбэки еще пишут в каталог
+#ifndef _WIN32
+    std::unique_ptr<LiveTelemetryRing> live;      // под bufferMutex
+#endif
+    std::thread writer;
+
+    void writeRollups(const std::string& dataPath) {
+        TelemetryRollupHeader::build(buffer, rollupLevels);
+        TelemetryRollupHeader h{};
+        std::memcpy(h.magic, TelemetryRollupHeader::MAGIC, sizeof h.magic);
+        h.version = TelemetryRollupHeader::VERSION;
+        h.levelCount = TelemetryRollupHeader::LEVELS;
+        h.endianTag = TelemetryFileHeader::ENDIAN_TAG;
+        h.bucketSize = sizeof(TelemetryRollupBucket);
+        for (int l = 0; l < TelemetryRollupHeader::LEVELS; l++) {
+            h.counts[l] = static_cast<uint32_t>(rollupLevels[l].size());
+            h.widths[l] = TelemetryRollupHeader::WIDTHS[l];
+        }
+        int fd = io.open(TelemetryRollupHeader::pathFor(dataPath));
+        if (fd < 0) return;
+        io.write(fd, &h, sizeof h);
+        for (const auto& level : rollupLevels) {
+            io.write(fd, level.data(), level.size() * sizeof(TelemetryRollupBucket));
+        }
+        io.close(fd);
+    }
+
+    void appendCatalog(int fileNumber, const TelemetryFileHeader& header,
+        const std::vector<TelemetryCatalog::BlockEntry>& blocks) {
+        if (!catalog.is_open()) catalog.open(TelemetryCatalog::path(baseFilename), std::ios::binary | std::ios::app);
+        TelemetryCatalog::FileEntry fe{ TelemetryCatalog::ENTRY_MAGIC, static_cast<uint32_t>(fileNumber), header.encoding,
+            static_cast<uint32_t>(blocks.size()), header.recordCount, header.timeMin, header.timeMax, 0, 0 };
+        // Файл уже закрыт: размер и время изменения окончательные
+        if (!TelemetryCatalog::stamp(baseFilename + "_" + std::to_string(fileNumber) + ".bin", fe.fileBytes, fe.modified)) return;
+        catalog.write(reinterpret_cast<const char*>(&fe), sizeof fe);
+        catalog.write(reinterpret_cast<const char*>(blocks.data()), blocks.size() * sizeof(TelemetryCatalog::BlockEntry));
+        catalog.flush();
+    }
+
+    void writeBuffer() {
+        if (buffer.empty()) return;
+        int fileNumber = fileCounter++;
+        std::string filename = baseFilename + "_" + std::to_string(fileNumber) + ".bin";
+        io.setSyncPolicy(static_cast<AsyncFileWriter::SyncPolicy>(syncPolicy.load(std::memory_order_relaxed)));
+        int fd = io.open(filename);
+        if (fd < 0) {
+            buffer.clear();
+            return;
+        }
+        bool gorilla = compress.load(std::memory_order_relaxed);
+        TelemetryFileHeader header = TelemetryFileHeader::make(buffer.data(), buffer.size(),
+            gorilla ? TelemetryFileHeader::ENCODING_GORILLA : TelemetryFileHeader::ENCODING_RAW);
+        io.write(fd, &header, sizeof header);
+        blockIndex.clear();
+        if (gorilla) {
+            encoded.clear();
+            for (size_t i = 0; i < buffer.size(); i += GorillaCodec::BLOCK_RECORDS) {
+                size_t n = std::min(GorillaCodec::BLOCK_RECORDS, buffer.size() - i);
+                size_t at = encoded.size();
+                GorillaCodec::encodeBlock(buffer.data() + i, n, encoded, bits);
+                TelemetryBlockHeader bh;
+                std::memcpy(&bh, encoded.data() + at, sizeof bh);
+                blockIndex.push_back({ sizeof header + at, bh.count, 0, bh.timeMin, bh.timeMax });
+            }
+            io.write(fd, encoded.data(), encoded.size());
+        } else {
+            for (size_t i = 0; i < buffer.size(); i += TelemetryCatalog::BLOCK_RECORDS) {
+                size_t n = std::min(TelemetryCatalog::BLOCK_RECORDS, buffer.size() - i);
+                TelemetryCatalog::BlockEntry be{ sizeof header + i * sizeof(TelemetryData), static_cast<uint32_t>(n), 0,
+                    buffer[i].time, buffer[i].time };
+                for (size_t k = i; k < i + n; k++) {
+                    be.timeMin = std::min(be.timeMin, buffer[k].time);
+                    be.timeMax = std::max(be.timeMax, buffer[k].time);
+                }
+                blockIndex.push_back(be);
+            }
+            io.write(fd, buffer.data(), buffer.size() * sizeof(TelemetryData));
+        }
+        // Каталог дописывается, когда файл целиком записан и закрыт
+        io.close(fd, [this, fileNumber, header, blocks = blockIndex]() { appendCatalog(fileNumber, header, blocks); });
+        writeRollups(filename);
+        buffer.clear();
+    }
+
+    // Переносит все доступные записи из очереди, файлы пишутся по заполнении пачки
+    bool drain() {
+        bool any = false;
+        TelemetryData d;
+        std::lock_guard<std::mutex> lock(bufferMutex);
+        while (ring.tryPop(d)) {
+            any = true;
+#ifndef _WIN32
+            if (live) live->publish(d);
+#endif
+            buffer.push_back(d);
+            if (buffer.size() >= maxEntries) writeBuffer();
+        }
+        return any;
+    }
+
+    void writerLoop() {
+        while (running.load(std::memory_order_acquire)) {
+            bool any = drain();
+            uint64_t requested = flushRequested.load(std::memory_order_acquire);
+            if (requested != flushDone.load(std::memory_order_relaxed)) {
+                drain();
+                {
+                    std::lock_guard<std::mutex> lock(bufferMutex);
+                    writeBuffer();
+                }
+                io.flush();
+                flushDone.store(requested, std::memory_order_release);
+            } else if (uint64_t sync = syncRequested.load(std::memory_order_acquire); sync != syncDone.load(std::memory_order_relaxed)) {
+                io.flush();
+                syncDone.store(sync, std::memory_order_release);
+            } else if (!any) {
+                io.flush();
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            } else {
+                io.poll();
+            }
+        }
+        drain();
+        std::lock_guard<std::mutex> lock(bufferMutex);
+        writeBuffer();
+        io.flush();
+    }
+
+public:
+    explicit TelemetryLogger(size_t ringCapacity = 1 << 16) : ring(ringCapacity) {
+        buffer.reserve(maxEntries);
+        writer = std::thread(&TelemetryLogger::writerLoop, this);
+    }
+
+    ~TelemetryLogger() {
+        running.store(false, std::memory_order_release);
+        writer.join();
+    }
+
+    TelemetryLogger(const TelemetryLogger&) = delete;
+    TelemetryLogger& operator=(const TelemetryLogger&) = delete;
+
+    // Можно вызывать из нескольких потоков; false - очередь заполнена, запись отброшена
+    bool logData(double time, double altitude, double speed, double heading, double fuel) {
+        if (ring.tryPush({ time, altitude, speed, heading, fuel })) return true;
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    uint64_t droppedCount() const { return dropped.load(std::memory_order_relaxed); }
+
+    // Следующие файлы пишутся сжатыми блоками (GorillaCodec)
+    void setCompression(bool enabled) { compress.store(enabled, std::memory_order_relaxed); }
+
+    // Когда вызывать fsync для файлов ротации (по умолчанию - не вызывать)
+    void setSyncPolicy(AsyncFileWriter::SyncPolicy policy) { syncPolicy.store(static_cast<int>(policy), std::memory_order_relaxed); }
+    bool usingIoUring() const { return io.usingIoUring(); }
+
+    // Публикует каждую запись в разделяемую память name (последние capacity записей),
+    // как только писатель забирает ее из очереди. Пустое имя отключает.
+    bool enableLiveRing(const std::string& name, size_t capacity = 4096) {
+#ifndef _WIN32
+        std::unique_ptr<LiveTelemetryRing> ring;
+        if (!name.empty()) {
+            ring = std::make_unique<LiveTelemetryRing>(name, capacity);
+            if (!ring->isOpen()) return false;
+        }
+        std::lock_guard<std::mutex> lock(bufferMutex);
+        live = std::move(ring);
+        return true;
+#else
+        (void)capacity;
+        return name.empty();
+#endif
+    }
+
+    // Дожидается, пока все записанные до вызова данные окажутся в файлах
+    // (неполная пачка уходит в отдельный файл)
+    void rotateFileIfNeeded() {
+        uint64_t ticket = flushRequested.fetch_add(1, std::memory_order_acq_rel) + 1;
+        while (flushDone.load(std::memory_order_acquire) < ticket) {
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+    }
+
+    // Копия записей одного файла; для обхода без копирования - TelemetryFile и TelemetryArchive
+    std::vector<TelemetryData> readLogFile(const std::string& filename) {
+        TelemetryFile file;
+        std::vector<TelemetryData> data;
+        if (!file.open(filename) || !file.readAll(data)) return {};
+        return data;
+    }
+
+    // Сводка по всем файлам ротации и еще не записанной пачке
+    TelemetrySummary summarize(unsigned threads = 0) {
+        for (;;) {
+            int filesBefore;
+            {
+                std::lock_guard<std::mutex> lock(bufferMutex);
+                filesBefore = fileCounter;
+            }
+            // Файлы, отданные на асинхронную запись, должны лечь на диск
+            uint64_t ticket = syncRequested.fetch_add(1, std::memory_order_acq_rel) + 1;
+            while (syncDone.load(std::memory_order_acquire) < ticket) {
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+            }
+            // Ротация меняет fileCounter под bufferMutex: если он прежний, список файлов
+            // и копия пачки согласованы. Файлы читаются без блокировки, drain() не ждет
+            TelemetryArchive archive(baseFilename);
+            std::vector<TelemetryData> pending;
+            {
+                std::lock_guard<std::mutex> lock(bufferMutex);
+                if (fileCounter != filesBefore) continue;
+                pending = buffer;
+            }
+            TelemetrySummary summary = TelemetrySummary::collect(archive, threads);
+            for (const auto& d : pending) summary.add(d);
+            return summary;
+        }
+    }
+
+    void printLogSummary() {
+        summarize().print(std::cout);
+    }
+};
+
+struct Waypoint {
+    int id;
+    double x, y, z, speed;
+    std::string desc;
+};
+
+// Иерархия ограничивающих параллелепипедов (BVH) над участками маршрута;
+// участок i соединяет точки i и i+1
+class RouteSegmentIndex {
+public:
+    struct Hit {
+        size_t leg = SIZE_MAX;       // номер участка
+        double t = 0.0;              // положение проекции на участке, 0..1
+        double crossTrack = std::numeric_limits<double>::infinity();   // расстояние до участка
+        double alongTrack = 0.0;     // пройдено по участку от его начала
+        double progress = 0.0;       // пройдено по маршруту от первой точки
+
+        bool valid() const { return leg != SIZE_MAX; }
+    };
+
+private:
+    static constexpr uint32_t LEAF_SIZE = 4;
+
+    struct Node {
+        double lo[3], hi[3];
+        uint32_t legMin, legMax;     // диапазон номеров участков в поддереве
+        uint32_t start, count;       // лист: участки legs[start .. start+count)
+        uint32_t right;              // внутренний узел: левый потомок - следующий узел
+    };
+
+    std::vector<double> px, py, pz;
+    std::vector<double> cumulative;  // длина маршрута до начала участка
+    std::vector<Node> nodes;
+    std::vector<uint32_t> legs;
+
+    uint32_t build(uint32_t begin, uint32_t end, std::vector<double>& centers) {
+        uint32_t index = static_cast<uint32_t>(nodes.size());
+        nodes.push_back({});
+        Node node;
+        for (int a = 0; a < 3; a++) {
+            node.lo[a] = std::numeric_limits<double>::infinity();
+            node.hi[a] = -std::numeric_limits<double>::infinity();
+        }
+        node.legMin = UINT32_MAX;
+        node.legMax = 0;
+        double clo[3] = { INFINITY, INFINITY, INFINITY }, chi[3] = { -INFINITY, -INFINITY, -INFINITY };
+        for (uint32_t k = begin; k < end; k++) {
+            uint32_t leg = legs[k];
+            const double a[3] = { px[leg], py[leg], pz[leg] };
+            const double b[3] = { px[leg + 1], py[leg + 1], pz[leg + 1] };
+            for (int ax = 0; ax < 3; ax++) {
+                node.lo[ax] = std::min(node.lo[ax], std::min(a[ax], b[ax]));
+                node.hi[ax] = std::max(node.hi[ax], std::max(a[ax], b[ax]));
+                clo[ax] = std::min(clo[ax], centers[3 * leg + ax]);
+                chi[ax] = std::max(chi[ax], centers[3 * leg + ax]);
+            }
+            node.legMin = std::min(node.legMin, leg);
+            node.legMax = std::max(node.legMax, leg);
+        }
+        if (end - begin <= LEAF_SIZE) {
+            node.start = begin;
+            node.count = end - begin;
+            node.right = 0;
+            nodes[index] = node;
+            return index;
+        }
+        // Деление по медиане центров вдоль самой длинной оси
+        int axis = 0;
+        for (int ax = 1; ax < 3; ax++) {
+            if (chi[ax] - clo[ax] > chi[axis] - clo[axis]) axis = ax;
+        }
+        uint32_t mid = begin + (end - begin) / 2;
+        std::nth_element(legs.begin() + begin, legs.begin() + mid, legs.begin() + end,
+            [&centers, axis](uint32_t l, uint32_t r) { return centers[3 * l + axis] < centers[3 * r + axis]; });
+        node.start = 0;
+        node.count = 0;
+        build(begin, mid, centers);
+        node.right = build(mid, end, centers);
+        nodes[index] = node;
+        return index;
+    }
+
+    static double boxDistance2(const Node& n, double x, double y, double z) {
+        const double p[3] = { x, y, z };
+        double d2 = 0.0;
+        for (int a = 0; a < 3; a++) {
+            double d = std::max({ n.lo[a] - p[a], 0.0, p[a] - n.hi[a] });
+            d2 += d * d;
+        }
+        return d2;
+    }
+
+    // Квадрат расстояния до участка и параметр проекции
+    double legDistance2(size_t leg, double x, double y, double z, double& t) const {
+        double ax = px[leg], ay = py[leg], az = pz[leg];
+        double dx = px[leg + 1] - ax, dy = py[leg + 1] - ay, dz = pz[leg + 1] - az;
+        double len2 = dx * dx + dy * dy + dz * dz;
+        t = len2 > 0.0 ? ((x - ax) * dx + (y - ay) * dy + (z - az) * dz) / len2 : 0.0;
+        t = std::clamp(t, 0.0, 1.0);
+        double ex = ax + t * dx - x, ey = ay + t * dy - y, ez = az + t * dz - z;
+        return ex * ex + ey * ey + ez * ez;
+    }
+
+public:
+    void build(const std::vector<double>& xs, const std::vector<double>& ys, const std::vector<double>& zs) {
+        px = xs;
+        py = ys;
+        pz = zs;
+        nodes.clear();
+        legs.clear();
+        cumulative.assign(1, 0.0);
+        size_t legCount = px.size() > 1 ? px.size() - 1 : 0;
+        for (size_t i = 0; i < legCount; i++) cumulative.push_back(cumulative.back() + legLength(i));
+        if (legCount == 0) return;
+        std::vector<double> centers(3 * legCount);
+        legs.resize(legCount);
+        for (size_t i = 0; i < legCount; i++) {
+            legs[i] = static_cast<uint32_t>(i);
+            centers[3 * i] = 0.5 * (px[i] + px[i + 1]);
+            centers[3 * i + 1] = 0.5 * (py[i] + py[i + 1]);
+            centers[3 * i + 2] = 0.5 * (pz[i] + pz[i + 1]);
+        }
+        nodes.reserve(2 * legCount / LEAF_SIZE + 1);
+        build(0, static_cast<uint32_t>(legCount), centers);
+    }
+
+    size_t legCount() const { return legs.size(); }
+
+    double legLength(size_t leg) const {
+        double dx = px[leg + 1] - px[leg], dy = py[leg + 1] - py[leg], dz = pz[leg + 1] - pz[leg];
+        return std::sqrt(dx * dx + dy * dy + dz * dz);
+    }
+
+    // Ближайший к позиции участок среди участков firstLeg..lastLeg
+    Hit nearestSegment(double x, double y, double z, size_t firstLeg = 0, size_t lastLeg = SIZE_MAX) const {
+        Hit best;
+        if (nodes.empty() || firstLeg >= legs.size()) return best;
+        lastLeg = std::min(lastLeg, legs.size() - 1);
+        double best2 = std::numeric_limits<double>::infinity();
+        double bestT = 0.0;
+
+        // Короткое окно дешевле перебрать: отсечение по параллелепипедам тут не помогает
+        if (lastLeg - firstLeg < 64) {
+            for (size_t leg = firstLeg; leg <= lastLeg; leg++) {
+                double t;
+                double d2 = legDistance2(leg, x, y, z, t);
+                if (d2 < best2) {
+                    best2 = d2;
+                    bestT = t;
+                    best.leg = leg;
+                }
+            }
+        }
+
+        uint32_t stack[64];
+        int top = 0;
+        if (!best.valid()) stack[top++] = 0;
+        while (top > 0) {
+            const Node& n = nodes[stack[--top]];
+            if (n.legMax < firstLeg || n.legMin > lastLeg) continue;
+            if (boxDistance2(n, x, y, z) >= best2) continue;
+            if (n.count > 0) {
+                for (uint32_t k = n.start; k < n.start + n.count; k++) {
+                    uint32_t leg = legs[k];
+                    if (leg < firstLeg || leg > lastLeg) continue;
+                    double t;
+                    double d2 = legDistance2(leg, x, y, z, t);
+                    if (d2 < best2 || (d2 == best2 && leg < best.leg)) {
+                        best2 = d2;
+                        bestT = t;
+                        best.leg = leg;
+                    }
+                }
+                continue;
+            }
+            // Ближний потомок обходится первым
+            uint32_t left = static_cast<uint32_t>(&n - nodes.data()) + 1;
+            double dl = boxDistance2(nodes[left], x, y, z);
+            double dr = boxDistance2(nodes[n.right], x, y, z);
+            if (top + 2 > 64) continue;
+            if (dl < dr) {
+                stack[top++] = n.right;
+                stack[top++] = left;
+            } else {
+                stack[top++] = left;
+                stack[top++] = n.right;
+            }
+        }
+        if (best.valid()) {
+            best.t = bestT;
+            best.crossTrack = std::sqrt(best2);
+            best.alongTrack = bestT * legLength(best.leg);
+            best.progress = cumulative[best.leg] + best.alongTrack;
+        }
+        return best;
+    }
+
+    // Параметр проекции на прямую участка без ограничения 0..1 (> 1 - точка конца пройдена)
+    double projectUnclamped(size_t leg, double x, double y, double z) const {
+        double dx = px[leg + 1] - px[leg], dy = py[leg + 1] - py[leg], dz = pz[leg + 1] - pz[leg];
+        double len2 = dx * dx + dy * dy + dz * dz;
+        if (len2 == 0.0) return 1.0;
+        return ((x - px[leg]) * dx + (y - py[leg]) * dy + (z - pz[leg]) * dz) / len2;
+    }
+};
+
+class WaypointManager {
+private:
+    static constexpr double REACH_TOLERANCE = 10.0;   // м
+    static constexpr size_t LOOKAHEAD_LEGS = 8;       // окно поиска пролета вперед по маршруту
+    static constexpr double CORRIDOR = 50.0;          // м, полуширина коридора участка
+
+    // Координаты и скорость - плотными массивами, описание - номер в пуле строк
+    std::vector<int> ids;
+    std::vector<double> xs, ys, zs, speeds;
+    std::vector<uint32_t> descs;
+    std::unique_ptr<StringPool> descPool = std::make_unique<StringPool>();
+    size_t currentIndex = 0;
+    RouteSegmentIndex legIndex;
+    bool legIndexDirty = true;
+
+    const RouteSegmentIndex& segments() {
+        if (legIndexDirty) {
+            legIndex.build(xs, ys, zs);
+            legIndexDirty = false;
+        }
+        return legIndex;
+    }
+
+public:
+    void addWaypoint(int id, double x, double y, double z, double speed, const std::string& desc) {
+        ids.push_back(id);
+        xs.push_back(x);
+        ys.push_back(y);
+        zs.push_back(z);
+        speeds.push_back(speed);
+        descs.push_back(descPool->intern(desc));
+        legIndexDirty = true;
+    }
+
+    size_t size() const { return ids.size(); }
+
+    bool saveRoute() {
+        std::ofstream file("waypoints.bd");
+        for (size_t i = 0; i < ids.size(); i++) {
+            file << ids[i] << "," << xs[i] << "," << ys[i] << "," << zs[i] << "," << speeds[i] << ","
+                << descPool->get(descs[i]) << "\n";
+        }
+        file.close();
+        return true;
+    }
+
+    bool loadRoute() {
+        std::ifstream file("waypoints.bd");
+        ids.clear(); xs.clear(); ys.clear(); zs.clear(); speeds.clear(); descs.clear();
+        descPool = std::make_unique<StringPool>();
+        currentIndex = 0;
+        legIndexDirty = true;
+        int id;
+        double x, y, z, speed;
+        std::string desc;
+        char comma;
+        while (file >> id >> comma >> x >> comma >> y >> comma >> z >> comma >> speed >> comma && std::getline(file, desc)) {
+            addWaypoint(id, x, y, z, speed, desc);
+        }
+        file.close();
+        return !ids.empty();
+    }
+
+    double calculateTotalDistance() {
+        double dist = 0.0;
+        for (size_t i = 1; i < xs.size(); i++) {
+            double dx = xs[i] - xs[i - 1];
+            double dy = ys[i] - ys[i - 1];
+            double dz = zs[i] - zs[i - 1];
+            dist += sqrt(dx * dx + dy * dy + dz * dz);
+        }
+        return dist;
+    }
+
+    Waypoint getNextWaypoint() {
+        if (currentIndex < ids.size()) {
+            size_t i = currentIndex;
+            return { ids[i], xs[i], ys[i], zs[i], speeds[i], std::string(descPool->get(descs[i])) };
+        }
+        return {};
+    }
+
+    // Ближайший участок маршрута: боковое отклонение, пройденный путь, активный участок
+    RouteSegmentIndex::Hit nearestSegment(double x, double y, double z) {
+        return segments().nearestSegment(x, y, z);
+    }
+
+    size_t getCurrentIndex() const { return currentIndex; }
+
+    // Точка i пройдена: в допуске, проекция за концом участка i-1 или срезан угол
+    // (в коридоре участка i, вне коридора i-1). За вызов - не больше одной точки
+    bool checkWaypointReached(double x, double y, double z) {
+        if (currentIndex >= ids.size()) return false;
+        size_t i = currentIndex;
+        double dx = x - xs[i], dy = y - ys[i], dz = z - zs[i];
+        bool passed = dx * dx + dy * dy + dz * dz < REACH_TOLERANCE * REACH_TOLERANCE;
+        const RouteSegmentIndex& route = segments();
+        if (!passed && i > 0 && i - 1 < route.legCount()) passed = route.projectUnclamped(i - 1, x, y, z) >= 1.0;
+        if (!passed && i < route.legCount()) {
+            RouteSegmentIndex::Hit hit = route.nearestSegment(x, y, z, i > 0 ? i - 1 : 0, i + LOOKAHEAD_LEGS);
+            passed = hit.valid() && hit.leg == i && hit.t > 0.0 && hit.crossTrack < CORRIDOR &&
+                (i == 0 || route.nearestSegment(x, y, z, i - 1, i - 1).crossTrack >= CORRIDOR);
+        }
+        if (!passed) return false;
+        currentIndex++;
+        return true;
+    }
+};
+
+// Правила по индексам полей; данные проверяются колонками блоками по 64 записи,
+// хранятся только счетчики и первые MAX_SAMPLES нарушений
+class DataValidator {
+public:
+    enum Field : uint8_t { X, Y, Z, SPEED, ACCELERATION, FIELD_COUNT };
+    static constexpr size_t BLOCK = 64;
+    static constexpr size_t MAX_SAMPLES = 16;
+
+    // Колонки одной пачки записей; nullptr - поля в пачке нет
+    struct Columns {
+        const double* field[FIELD_COUNT] = {};
+        size_t count = 0;
+    };
+
+    struct Sample {
+        uint64_t record;       // сквозной номер записи
+        Field field;
+        double value;
+    };
+
+private:
+    struct Rule {
+        double min, max;
+    };
+    Rule rules[FIELD_COUNT] = {};
+    bool active[FIELD_COUNT] = {};
+
+    uint64_t checked[FIELD_COUNT] = {};
+    uint64_t violations[FIELD_COUNT] = {};
+    uint64_t records = 0;
+    uint64_t invalidRecords = 0;
+    std::vector<Sample> samples;
+
+    static const char* fieldName(Field f) {
+        static const char* const names[FIELD_COUNT] = { "x", "y", "z", "speed", "acceleration" };
+        return names[f];
+    }
+
+    static std::optional<Field> fieldIndex(const std::string& name) {
+        for (int f = 0; f < FIELD_COUNT; f++) {
+            if (name == fieldName(static_cast<Field>(f))) return static_cast<Field>(f);
+        }
+        return std::nullopt;
+    }
+
+    // Маска нарушений для len <= 64 значений, NaN - нарушение; флаги-байты
+    // сжимаются в биты умножением по 8 за раз
+    static uint64_t rangeMask(const double* v, size_t len, Rule r) {
+        alignas(8) uint8_t bad[BLOCK] = {};
+        for (size_t j = 0; j < len; j++) {
+            bad[j] = static_cast<uint8_t>(!(v[j] >= r.min) | !(v[j] <= r.max));
+        }
+        uint64_t mask = 0;
+        for (size_t j = 0; j < len; j += 8) {
+            uint64_t bytes;
+            std::memcpy(&bytes, bad + j, 8);
+            mask |= ((bytes * 0x0102040810204080ULL) >> 56) << j;
+        }
+        return mask;
+    }
+
+    void keepSamples(const double* column, uint64_t mask, uint64_t base, Field f) {
+        for (; mask && samples.size() < MAX_SAMPLES; mask &= mask - 1) {
+            int j = trailingZeros64(mask);
+            samples.push_back({ base + j, f, column[j] });
+        }
+    }
+
+    // Маска невалидных записей блока; счетчики полей и примеры обновляются,
+    // счетчики записей - нет. firstRecord == NO_RECORD - без примеров
+    static constexpr uint64_t NO_RECORD = UINT64_MAX;
+
+    uint64_t checkBlock(const Columns& c, size_t base, size_t len, uint64_t firstRecord) {
+        uint64_t combined = 0;
+        for (int f = 0; f < FIELD_COUNT; f++) {
+            if (!active[f] || !c.field[f]) continue;
+            uint64_t mask = rangeMask(c.field[f] + base, len, rules[f]);
+            checked[f] += len;
+            violations[f] += popCount64(mask);
+            if (mask && firstRecord != NO_RECORD && samples.size() < MAX_SAMPLES) {
+                keepSamples(c.field[f] + base, mask, firstRecord, static_cast<Field>(f));
+            }
+            combined |= mask;
+        }
+        return combined;
+    }
+
+    // Отдельная проверка - одна запись в счетчиках и оценке, но без примеров
+    bool validateSingle(const Columns& c) {
+        bool valid = checkBlock(c, 0, 1, NO_RECORD) == 0;
+        records++;
+        if (!valid) invalidRecords++;
+        return valid;
+    }
+
+    bool validateOne(Field f, double value) {
+        Columns c;
+        c.field[f] = &value;
+        c.count = 1;
+        return validateSingle(c);
+    }
+
+public:
+    // Неизвестное имя поля - false
+    bool addValidationRule(const std::string& field, double min, double max) {
+        std::optional<Field> f = fieldIndex(field);
+        if (!f) return false;
+        rules[*f] = { min, max };
+        active[*f] = true;
+        return true;
+    }
+
+    // Проверка пачки; invalid (если задан) получает маску невалидных записей
+    // на каждые 64 записи. Возвращает число невалидных записей в пачке.
+    size_t validateBatch(const Columns& c, uint64_t* invalid = nullptr) {
+        size_t bad = 0;
+        for (size_t base = 0; base < c.count; base += BLOCK) {
+            size_t len = std::min(BLOCK, c.count - base);
+            uint64_t combined = checkBlock(c, base, len, records + base);
+            if (invalid) invalid[base / BLOCK] = combined;
+            bad += popCount64(combined);
+        }
+        records += c.count;
+        invalidRecords += bad;
+        return bad;
+    }
+
+    bool validateCoordinates(double x, double y, double z) {
+        Columns c;
+        c.field[X] = &x;
+        c.field[Y] = &y;
+        c.field[Z] = &z;
+        c.count = 1;
+        return validateSingle(c);
+    }
+
+    bool validateSpeed(double speed) {
+        return validateOne(SPEED, speed);
+    }
+
+    bool validateAcceleration(double acceleration) {
+        return validateOne(ACCELERATION, acceleration);
+    }
+
+    uint64_t violationCount(Field f) const { return violations[f]; }
+    uint64_t checkedCount(Field f) const { return checked[f]; }
+    uint64_t recordCount() const { return records; }
+    uint64_t invalidCount() const { return invalidRecords; }
+    const std::vector<Sample>& firstViolations() const { return samples; }
+
+    void reset() {
+        std::fill(std::begin(checked), std::end(checked), 0);
+        std::fill(std::begin(violations), std::end(violations), 0);
+        records = invalidRecords = 0;
+        samples.clear();
+    }
+
+    void generateValidationReport() {
+        std::ofstream file("validation_report.txt");
+        file << "Отчет валидации:\n";
+        file << "Записей: " << records << ", невалидных: " << invalidRecords << "\n";
+        for (int f = 0; f < FIELD_COUNT; f++) {
+            if (!active[f]) continue;
+            file << fieldName(static_cast<Field>(f)) << " [" << rules[f].min << ", " << rules[f].max << "]: "
+                << violations[f] << " нарушений из " << checked[f] << "\n";
+        }
+        if (!samples.empty()) {
+            file << "Первые нарушения:\n";
+            for (const auto& smp : samples) {
+                file << "  запись " << smp.record << ": " << fieldName(smp.field) << " = " << smp.value
+                    << " вне диапазона [" << rules[smp.field].min << ", " << rules[smp.field].max << "]\n";
+            }
+        }
+        file << "Общий результат: " << getValidationScore() * 100 << "% данных валидны\n";
+        file.close();
+    }
+
+    // Доля валидных записей
+    double getValidationScore() const {
+        return records ? static_cast<double>(records - invalidRecords) / records : 1.0;
+    }
+};
+
+class TelemetryFilter {
+private:
+    std::vector<std::vector<std::string>> data;
+
+public:
+    bool loadFromCSV(const std::string& filename) {
+        std::ifstream file(filename);
+        if (!file.is_open()) return false;
+        std::string line;
+        while (std::getline(file, line)) {
+            std::stringstream ss(line);
+            std::vector<std::string> row;
+            std::string cell;
+            while (std::getline(ss, cell, ',')) {
+                row.push_back(cell);
+            }
+            data.push_back(row);
+        }
+        file.close();
+        return true;
+    }
+
+    void filterData() {
+        auto isValidAltitude = [](double alt) { return alt >= 0 && alt <= 20000; };
+        auto isValidSpeed = [](double speed) { return speed >= 0 && speed <= 500; };
+
+        std::vector<std::vector<std::string>> filtered;
+        filtered.push_back(data[0]); // header
+        for (size_t i = 1; i < data.size(); i++) {
+            double alt = std::stod(data[i][1]);
+            double speed = std::stod(data[i][2]);
+            if (isValidAltitude(alt) && isValidSpeed(speed)) {
+                filtered.push_back(data[i]);
+            }
+        }
+        data = filtered;
+    }
+
+    bool saveToCSV(const std::string& filename) {
+        std::ofstream file(filename);
+        for (const auto& row : data) {
+            for (size_t j = 0; j < row.size(); j++) {
+                file << row[j];
+                if (j < row.size() - 1) file << ",";
+            }
+            file << "\n";
+        }
+        file.close();
+        return true;
+    }
+
+    void printFilteredStats() {
+        std::cout << "Filtered rows: " << data.size() - 1 << "\n";
+    }
+};
+
+// Открытый маршрут через все точки от узла 0: ближайший сосед, затем 2-opt и
+// Or-opt по спискам кандидатов; параллельные перезапуски, побеждает кратчайший
+class RouteOptimizer {
+public:
+    struct Result {
+        std::vector<uint32_t> route;    // узлы по порядку, route[0] == 0
+        double length = 0.0;
+    };
+
+private:
+    static constexpr size_t NEIGHBORS = 10;
+    static constexpr unsigned DEFAULT_RESTARTS = 8;   // не зависит от машины: маршрут воспроизводим
+    static constexpr uint32_t NONE = UINT32_MAX;
+    static constexpr double EPS = 1e-9;
+
+    std::vector<double> px, py, pz;
+    std::vector<uint32_t> neighbors;      // NEIGHBORS ближайших для каждого узла, по возрастанию
+    size_t k = 0;
+
+    double dist(uint32_t a, uint32_t b) const {
+        double dx = px[a] - px[b], dy = py[a] - py[b], dz = pz[a] - pz[b];
+        return std::sqrt(dx * dx + dy * dy + dz * dz);
+    }
+
+    const uint32_t* near(uint32_t node) const { return &neighbors[node * k]; }
+
+    void buildNeighbors() {
+        size_t n = px.size();
+        k = std::min(NEIGHBORS, n - 1);
+        neighbors.assign(n * k, 0);
+        if (k == 0) return;
+        double lo[3] = { INFINITY, INFINITY, INFINITY }, hi[3] = { -INFINITY, -INFINITY, -INFINITY };
+        for (size_t i = 0; i < n; i++) {
+            const double c[3] = { px[i], py[i], pz[i] };
+            for (int a = 0; a < 3; a++) {
+                lo[a] = std::min(lo[a], c[a]);
+                hi[a] = std::max(hi[a], c[a]);
+            }
+        }
+        double extent = std::max({ hi[0] - lo[0], hi[1] - lo[1], hi[2] - lo[2], 1e-6 });
+        SpatialGrid grid(extent / std::max(1.0, std::cbrt(static_cast<double>(n))));
+        for (size_t i = 0; i < n; i++) grid.insert(static_cast<int>(i), px[i], py[i], pz[i]);
+        for (size_t i = 0; i < n; i++) {
+            size_t filled = 0;
+            for (const auto& hit : grid.nearest(k + 1, px[i], py[i], pz[i])) {
+                if (hit.id == static_cast<int>(i) || filled == k) continue;
+                neighbors[i * k + filled++] = static_cast<uint32_t>(hit.id);
+            }
+        }
+    }
+
+    // Ближайший сосед; при rng - иногда второй ближайший, для разнообразия перезапусков
+    void construct(std::vector<uint32_t>& route, std::mt19937_64* rng) const {
+        size_t n = px.size();
+        std::vector<char> visited(n, 0);
+        route.assign(1, 0);
+        visited[0] = 1;
+        std::uniform_real_distribution<double> coin(0.0, 1.0);
+        while (route.size() < n) {
+            uint32_t cur = route.back();
+            uint32_t first = NONE, second = NONE;
+            for (size_t j = 0; j < k; j++) {
+                uint32_t c = near(cur)[j];
+                if (visited[c]) continue;
+                if (first == NONE) first = c;
+                else {
+                    second = c;
+                    break;
+                }
+            }
+            if (first == NONE) {
+                // Все кандидаты заняты - полный перебор; при NaN в координатах - любой непосещенный
+                double best = INFINITY;
+                for (uint32_t c = 0; c < n; c++) {
+                    if (visited[c]) continue;
+                    if (first == NONE || dist(cur, c) < best) {
+                        best = dist(cur, c);
+                        first = c;
+                    }
+                }
+            }
+            uint32_t next = (rng && second != NONE && coin(*rng) < 0.1) ? second : first;
+            visited[next] = 1;
+            route.push_back(next);
+        }
+    }
+
+    static void indexPositions(const std::vector<uint32_t>& route, std::vector<uint32_t>& pos) {
+        pos.resize(route.size());
+        for (size_t i = 0; i < route.size(); i++) pos[route[i]] = static_cast<uint32_t>(i);
+    }
+
+    void reverse(std::vector<uint32_t>& route, std::vector<uint32_t>& pos, size_t from, size_t to) const {
+        std::reverse(route.begin() + from, route.begin() + to + 1);
+        for (size_t i = from; i <= to; i++) pos[route[i]] = static_cast<uint32_t>(i);
+    }
+
+    // 2-opt: разворот участка, чтобы соединить узел с близким кандидатом
+    bool twoOpt(std::vector<uint32_t>& route, std::vector<uint32_t>& pos) const {
+        size_t n = route.size();
+        bool any = false;
+        for (size_t i = 0; i < n; i++) {
+            uint32_t a = route[i];
+            if (i + 1 < n) {
+                uint32_t b = route[i + 1];
+                double dab = dist(a, b);
+                for (size_t q = 0; q < k; q++) {
+                    uint32_t c = near(a)[q];
+                    double dac = dist(a, c);
+                    if (dac >= dab) break;
+                    size_t j = pos[c];
+                    if (j <= i + 1) continue;
+                    // a b ... c e  ->  a c ... b e
+                    double delta = dac - dab;
+                    if (j + 1 < n) delta += dist(b, route[j + 1]) - dist(c, route[j + 1]);
+                    if (delta < -EPS) {
+                        reverse(route, pos, i + 1, j);
+                        any = true;
+                        break;
+                    }
+                }
+            }
+            if (i >= 2) {
+                a = route[i];
+                uint32_t p = route[i - 1];
+                double dpa = dist(p, a);
+                for (size_t q = 0; q < k; q++) {
+                    uint32_t c = near(a)[q];
+                    double dac = dist(a, c);
+                    if (dac >= dpa) break;
+                    size_t j = pos[c];
+                    if (j == 0 || j + 1 >= i) continue;
+                    // cp c ... p a  ->  cp p ... c a
+                    uint32_t cp = route[j - 1];
+                    double delta = dac + dist(cp, p) - dist(cp, c) - dpa;
+                    if (delta < -EPS) {
+                        reverse(route, pos, j, i - 1);
+                        any = true;
+                        break;
+                    }
+                }
+            }
+        }
+        return any;
+    }
+
+    // Or-opt: перенос цепочки из 1-3 узлов (возможно, развернутой) к близкому кандидату
+    bool orOpt(std::vector<uint32_t>& route, std::vector<uint32_t>& pos) const {
+        size_t n = route.size();
+        bool any = false;
+        std::vector<uint32_t> segment;
+        for (size_t len = 1; len <= 3; len++) {
+            for (size_t i = 1; i + len <= n; i++) {
+                uint32_t s0 = route[i], sL = route[i + len - 1], p = route[i - 1];
+                uint32_t nx = i + len < n ? route[i + len] : NONE;
+                double gain = dist(p, s0);
+                if (nx != NONE) gain += dist(sL, nx) - dist(p, nx);
+                if (!(gain > EPS)) continue;    // и NaN: иначе перенос повторялся бы без конца
+
+                bool moved = false;
+                for (int end = 0; end < 2 && !moved; end++) {
+                    uint32_t from = end == 0 ? s0 : sL;
+                    for (size_t q = 0; q < k; q++) {
+                        uint32_t c = near(from)[q];
+                        double dc = dist(c, from);
+                        if (dc >= gain) break;
+                        size_t j = pos[c];
+                        if (j + 1 >= i && j < i + len) continue;     // сосед цепочки или внутри нее
+                        uint32_t cn = j + 1 < n ? route[j + 1] : NONE;
+                        // end == 0: c s0 .. sL cn;  end == 1: c sL .. s0 cn
+                        double add = dc;
+                        if (cn != NONE) add += dist(end == 0 ? sL : s0, cn) - dist(c, cn);
+                        if (!(gain - add > EPS)) continue;
+
+                        segment.assign(route.begin() + i, route.begin() + i + len);
+                        if (end == 1) std::reverse(segment.begin(), segment.end());
+                        route.erase(route.begin() + i, route.begin() + i + len);
+                        size_t at = (j < i ? j : j - len) + 1;
+                        route.insert(route.begin() + at, segment.begin(), segment.end());
+                        size_t lo = std::min(i, at), hi = std::max(i + len, at + len);
+                        for (size_t r = lo; r < std::min(hi, n); r++) pos[route[r]] = static_cast<uint32_t>(r);
+                        moved = any = true;
+                        break;
+                    }
+                }
+            }
+        }
+        return any;
+    }
+
+public:
+    // Узел 0 - стартовая позиция, остальные - точки маршрута
+    RouteOptimizer(std::vector<double> xs, std::vector<double> ys, std::vector<double> zs)
+        : px(std::move(xs)), py(std::move(ys)), pz(std::move(zs)) {
+        buildNeighbors();
+    }
+
+    double length(const std::vector<uint32_t>& route) const {
+        double total = 0.0;
+        for (size_t i = 1; i < route.size(); i++) total += dist(route[i - 1], route[i]);
+        return total;
+    }
+
+    // Один прогон: restart 0 - чистый ближайший сосед, остальные - со случайностью
+    Result solve(unsigned restart) const {
+        Result r;
+        std::mt19937_64 rng(0x9E3779B97F4A7C15ULL * (restart + 1));
+        construct(r.route, restart == 0 ? nullptr : &rng);
+        std::vector<uint32_t> pos;
+        indexPositions(r.route, pos);
+        bool improved = true;
+        while (improved) {
+            improved = twoOpt(r.route, pos);
+            improved = orOpt(r.route, pos) || improved;
+        }
+        r.length = length(r.route);
+        return r;
+    }
+
+    // Перезапуски делятся между потоками; результат не зависит от их числа.
+    // restarts == 0 - DEFAULT_RESTARTS, threads == 0 - по числу ядер
+    Result run(unsigned restarts = 0, unsigned threads = 0) const {
+        if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+        if (restarts == 0) restarts = DEFAULT_RESTARTS;
+        threads = std::min(threads, restarts);
+        std::vector<Result> best(threads);
+        std::vector<unsigned> bestRestart(threads, UINT_MAX);
+        std::atomic<unsigned> next{ 0 };
+        auto work = [&](unsigned t) {
+            for (unsigned r; (r = next.fetch_add(1)) < restarts;) {
+                Result candidate = solve(r);
+                if (bestRestart[t] == UINT_MAX || candidate.length < best[t].length ||
+                    (candidate.length == best[t].length && r < bestRestart[t])) {
+                    best[t] = std::move(candidate);
+                    bestRestart[t] = r;
+                }
+            }
+        };
+        std::vector<std::thread> workers;
+        for (unsigned t = 1; t < threads; t++) workers.emplace_back(work, t);
+        work(0);
+        for (auto& w : workers) w.join();
+        size_t winner = 0;
+        for (size_t t = 1; t < threads; t++) {
+            if (bestRestart[t] == UINT_MAX) continue;
+            if (bestRestart[winner] == UINT_MAX || best[t].length < best[winner].length ||
+                (best[t].length == best[winner].length && bestRestart[t] < bestRestart[winner])) winner = t;
+        }
+        return best[winner];
+    }
+};
+
+class WaypointSorter {
+private:
+    struct Waypoint {
+        int id;
+        double x, y, z;
+        std::string name;
+    };
+    std::vector<Waypoint> waypoints;
+    std::vector<double> distances;       // отдельно от записей - ключи сортировки
+    std::vector<uint32_t> order;         // порядок вывода, индексы в waypoints
+    RadixSorter sorter;
+
+public:
+    bool loadWaypoints(const std::string& filename) {
+        std::ifstream file(filename);
+        if (!file.is_open()) return false;
+        int id;
+        double x, y, z;
+        std::string name;
+        char comma;
+        while (file >> id >> comma >> x >> comma >> y >> comma >> z >> comma && std::getline(file, name)) {
+            waypoints.push_back({ id, x, y, z, name });
+        }
+        file.close();
+        distances.resize(waypoints.size(), 0.0);
+        order.resize(waypoints.size());
+        std::iota(order.begin(), order.end(), 0);
+        return true;
+    }
+
+    void calculateDistances(double current_x, double current_y, double current_z) {
+        for (size_t i = 0; i < waypoints.size(); i++) {
+            double dx = waypoints[i].x - current_x;
+            double dy = waypoints[i].y - current_y;
+            double dz = waypoints[i].z - current_z;
+            distances[i] = sqrt(dx * dx + dy * dy + dz * dz);
+        }
+    }
+
+    void sortByDistance() {
+        order = sorter.sort(distances.data(), distances.size());
+    }
+
+    // Порядок облета всех точек от текущей позиции (RouteOptimizer); возвращает
+    // длину маршрута. Результат сохраняется тем же saveSortedWaypoints.
+    double optimizeRoute(double current_x, double current_y, double current_z, unsigned restarts = 0) {
+        calculateDistances(current_x, current_y, current_z);
+        if (waypoints.empty()) return 0.0;
+        std::vector<double> xs{ current_x }, ys{ current_y }, zs{ current_z };
+        for (const auto& w : waypoints) {
+            xs.push_back(w.x);
+            ys.push_back(w.y);
+            zs.push_back(w.z);
+        }
+        RouteOptimizer optimizer(std::move(xs), std::move(ys), std::move(zs));
+        RouteOptimizer::Result best = optimizer.run(restarts);
+        order.clear();
+        for (size_t i = 1; i < best.route.size(); i++) order.push_back(best.route[i] - 1);
+        return best.length;
+    }
+
+    void saveSortedWaypoints(const std::string& filename) {
+        std::ofstream file(filename);
+        for (uint32_t i : order) {
+            const auto& w = waypoints[i];
+            file << w.id << "," << w.x << "," << w.y << "," << w.z << "," << w.name << "," << distances[i] << "\n";
+        }
+        file.close();
+    }
+};
+
+class FuelAnalyzer {
+private:
+    std::vector<double> time_data;
+    std::vector<double> fuel_data;
+    std::vector<double> rpm_data;
+
+public:
+    bool loadData(const std::string& filename) {
+        std::ifstream file(filename);
+        if (!file.is_open()) return false;
+        std::string header;
+        std::getline(file, header);
+        double t, f, r;
+        char comma;
+        while (file >> t >> comma >> f >> comma >> r) {
+            time_data.push_back(t);
+            fuel_data.push_back(f);
+            rpm_data.push_back(r);
+        }
+        file.close();
+        return true;
+    }
+
+    void detectAnomalies() {
+        double avg = calculateAverageConsumption();
+        auto isAnomaly = [avg](double consumption) { return consumption > avg * 1.5; };
+        for (size_t i = 0; i < fuel_data.size(); i++) {
+            if (isAnomaly(fuel_data[i])) {
+                std::cout << "Anomaly at time " << time_data[i] << ": " << fuel_data[i] << "\n";
+            }
+        }
+    }
+
+    double calculateAverageConsumption() {
+        if (fuel_data.empty()) return 0.0;
+        double sum = std::accumulate(fuel_data.begin(), fuel_data.end(), 0.0);
+        return sum / fuel_data.size();
+    }
+
+    void generateReport(const std::string& filename) {
+        std::ofstream file(filename);
+        file << "Average fuel consumption: " << calculateAverageConsumption() << "\n";
+        file << "Anomalies detected:\n";
+        // логика вывода аномалий
+        file.close();
+    }
+};
+
+class Aircraft {
+private:
+    std::map<std::string, double> params;
+
+public:
+    bool loadFromFile(const std::string& filename) {
+        std::ifstream file(filename);
+        if (!file.is_open()) return false;
+        std::string line;
+        while (std::getline(file, line)) {
+            size_t eq = line.find('=');
+            if (eq != std::string::npos) {
+                std::string key = line.substr(0, eq);
+                double value = std::stod(line.substr(eq + 1));
+                params[key] = value;
+            }
+        }
+        file.close();
+        return true;
+    }
+};
+
+class Environment {
+private:
+    std::vector<std::tuple<double, double, double>> atmosphereTable; // alt, density, pressure
+
+public:
+    bool loadAtmosphereTable(const std::string& filename) {
+        std::ifstream file(filename);
+        if (!file.is_open()) return false;
+        std::string header;
+        std::getline(file, header);
+        double alt, dens, press;
+        char comma;
+        while (file >> alt >> comma >> dens >> comma >> press) {
+            atmosphereTable.push_back({ alt, dens, press });
+        }
+        file.close();
+        return true;
+    }
+
+    double getDensity(double altitude) {
+        for (const auto& row : atmosphereTable) {
+            if (std::get<0>(row) >= altitude) return std::get<1>(row);
+        }
+        return 1.225; // default sea level
+    }
+};
+
+struct TrajectoryPoint {
+    double time, velocity, altitude, distance, fuel;
+};
+
+class Trajectory {
+private:
+    std::vector<TrajectoryPoint> points;
+    std::unique_ptr<AsyncFileWriter> csvWriter;   // создается при первом сохранении
+
+public:
+    bool saveToCSV(const std::string& filename) {
+        if (!csvWriter) csvWriter = std::make_unique<AsyncFileWriter>();
+        AsyncFileWriter& writer = *csvWriter;
+        writer.clearError();
+        int fd = writer.open(filename);
+        if (fd < 0) return false;
+        std::ostringstream chunk;
+        chunk << "time,velocity,altitude,distance,fuel\n";
+        for (size_t i = 0; i < points.size(); i++) {
+            const TrajectoryPoint& p = points[i];
+            chunk << p.time << "," << p.velocity << "," << p.altitude << ","
+                << p.distance << "," << p.fuel << "\n";
+            if (i % 4096 == 4095) {
+                writer.write(fd, chunk.str());
+                chunk.str({});
+            }
+        }
+        writer.write(fd, chunk.str());
+        writer.close(fd);
+        return writer.flush();
+    }
+
+    void generatePlotScript(const std::string& filename) {
+        std::ofstream file(filename);
+        file << "set terminal png\n";
+        file << "set output 'trajectory_plot.png'\n";
+        file << "plot 'trajectory.csv' using 1:3 with lines title 'Altitude'\n";
+        file.close();
+    }
+
+    void saveReport(const std::string& filename) {
+        double totalTime = 0, totalFuel = 0, avgVel = 0;
+        if (!points.empty()) {
+            totalTime = points.back().time;
+            totalFuel = points.back().fuel;
+            for (const auto& p : points) avgVel += p.velocity;
+            avgVel /= points.size();
+        }
+        std::ofstream file(filename);
+        file << "Total flight time: " << totalTime << " s\n";
+        file << "Total fuel consumed: " << totalFuel << " kg\n";
+        file << "Average velocity: " << avgVel << " m/s\n";
+        file.close();
+    }
+};
+
+// SEM6_NO_MAIN - для сборки вместе с SEM_6_tests.cpp
+#ifndef SEM6_NO_MAIN
+int main()
+{
+    std::cout << "Hello World!\n";
+}
+#endif
@@ -0,0 +1,1104 @@
+﻿// Проверки подсистем SEM_6.cpp.
+// Сборка: g++ -std=c++17 -O2 -pthread SEM_6_tests.cpp -o SEM_6_tests
+// Рабочие файлы создаются во временном каталоге и удаляются после прогона.
+#define SEM6_NO_MAIN
+#include "SEM_6.cpp"
+
+#include <array>
+#ifndef _WIN32
+#include <sys/wait.h>
+#endif
+
+static int failures = 0;
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": не выполнено " #cond "\n"; \
+            failures++; \
+        } \
+    } while (0)
+
+static std::filesystem::path workDir;
+
+static std::string tempPath(const std::string& name) {
+    return (workDir / name).string();
+}
+
+static void writeText(const std::string& path, const std::string& text) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out << text;
+}
+
+// ---------- TrajectoryLogger ----------
+
+static void testTrajectoryReloadResetsStatistics() {
+    std::string path = tempPath("trajectory.csv");
+    writeText(path, "time,x,y,z,speed\n0,0,0,0,10\n1,3,4,0,20\n2,6,8,0,30\n");
+    TrajectoryLogger log(path);
+    CHECK(log.loadFromCSV());
+    CHECK(log.getStatistics().pointCount == 3);
+    CHECK(std::fabs(log.calculateTotalDistance() - 10.0) < 1e-9);
+
+    // Только заголовок: прежние точки не должны остаться в статистике
+    writeText(path, "time,x,y,z,speed\n");
+    CHECK(log.loadFromCSV());
+    CHECK(log.getStatistics().pointCount == 0);
+    CHECK(log.calculateTotalDistance() == 0.0);
+    TrajectoryLogger::Sample s{};
+    CHECK(!log.stateAt(1.0, s));
+
+    writeText(path, "time,x,y,z,speed\n0,0,0,0,10\n1,3,4,0,20\n");
+    CHECK(log.loadFromCSV());
+    writeText(path, "");
+    CHECK(log.loadFromCSV());
+    CHECK(log.getStatistics().pointCount == 0);
+
+    std::filesystem::remove(path);
+    CHECK(!log.loadFromCSV());
+    CHECK(log.getStatistics().pointCount == 0);
+}
+
+static void testTrajectoryUnorderedQueries() {
+    TrajectoryLogger log(tempPath("unordered.csv"));
+    // Время идет не по порядку: 0, 2, 1, 3, 4
+    double times[] = { 0, 2, 1, 3, 4 };
+    for (double t : times) log.addPoint(t * 10, 0, 0, 100 + t, t);
+    CHECK(!log.getStatistics().timeMonotonic);
+
+    TrajectoryLogger::Sample s{};
+    CHECK(log.stateAt(1.5, s));
+    CHECK(std::fabs(s.x - 15.0) < 1e-9);
+    CHECK(std::fabs(s.speed - 101.5) < 1e-9);
+
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    std::vector<double> queries = { 3.5, nan, 0.5, 9.0, nan, 2.25 };
+    auto states = log.statesAt(queries);
+    CHECK(states.size() == queries.size());
+    CHECK(std::fabs(states[0].x - 35.0) < 1e-9);
+    CHECK(std::isnan(states[1].x) && std::isnan(states[4].speed));
+    CHECK(std::fabs(states[2].x - 5.0) < 1e-9);
+    CHECK(std::isnan(states[3].x));
+    CHECK(std::fabs(states[5].x - 22.5) < 1e-9);
+
+    auto recorded = log.range(0.5, 3.0);
+    CHECK(recorded.size() == 3);
+    CHECK(recorded.size() == 3 && recorded[0].time == 1 && recorded[1].time == 2 && recorded[2].time == 3);
+
+    // Константные запросы из нескольких потоков ничего не изменяют
+    std::vector<std::thread> readers;
+    std::atomic<int> mismatches{ 0 };
+    for (int r = 0; r < 4; r++) {
+        readers.emplace_back([&] {
+            for (int i = 0; i < 1000; i++) {
+                TrajectoryLogger::Sample q{};
+                if (!log.stateAt(2.5, q) || std::fabs(q.x - 25.0) > 1e-9) mismatches++;
+            }
+        });
+    }
+    for (auto& t : readers) t.join();
+    CHECK(mismatches == 0);
+}
+
+// ---------- SpatialGrid ----------
+
+static std::vector<SpatialGrid::Hit> bruteNearest(const std::vector<std::array<double, 3>>& pts, size_t k,
+    double x, double y, double z) {
+    std::vector<SpatialGrid::Hit> all;
+    for (size_t i = 0; i < pts.size(); i++) {
+        double dx = pts[i][0] - x, dy = pts[i][1] - y, dz = pts[i][2] - z;
+        all.push_back({ static_cast<int>(i), std::sqrt(dx * dx + dy * dy + dz * dz) });
+    }
+    std::sort(all.begin(), all.end(), [](const SpatialGrid::Hit& a, const SpatialGrid::Hit& b) {
+        return a.distance < b.distance;
+    });
+    all.resize(std::min(k, all.size()));
+    return all;
+}
+
+static void testSpatialGridQueries() {
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<double> coord(0.0, 50000.0);
+    std::vector<std::array<double, 3>> pts(2000);
+    SpatialGrid grid(1000.0);
+    for (size_t i = 0; i < pts.size(); i++) {
+        pts[i] = { coord(rng), coord(rng), coord(rng) / 10 };
+        CHECK(grid.insert(static_cast<int>(i), pts[i][0], pts[i][1], pts[i][2]));
+    }
+    const double far = 1e5 * 1000.0;
+    double queries[][3] = { { 100, 200, 300 }, { 25000, 25000, 2500 }, { -far, 0, 0 }, { far, far, far },
+        { 1e300, -1e300, 0 }, { 25000, 25000, far } };
+    for (auto& q : queries) {
+        auto t0 = std::chrono::steady_clock::now();
+        auto hits = grid.nearest(5, q[0], q[1], q[2]);
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+        auto expect = bruteNearest(pts, 5, q[0], q[1], q[2]);
+        CHECK(hits.size() == expect.size());
+        for (size_t i = 0; i < hits.size() && i < expect.size(); i++) {
+            CHECK(hits[i].distance == expect[i].distance);
+        }
+        CHECK(ms < 50.0);   // далекая точка не должна перебирать пустые кольца
+    }
+
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    CHECK(grid.nearest(3, nan, 0, 0).empty());
+    CHECK(grid.nearest(3, 0, INFINITY, 0).empty());
+    CHECK(grid.withinRadius(nan, 0, 0, 100).empty());
+    CHECK(grid.withinRadius(0, 0, 0, nan).empty());
+    CHECK(!grid.insert(-1, nan, 0, 0));
+    CHECK(grid.size() == pts.size());
+
+    auto inside = grid.withinRadius(25000, 25000, 2500, 3000);
+    size_t expectInside = 0;
+    for (const auto& p : pts) {
+        double dx = p[0] - 25000, dy = p[1] - 25000, dz = p[2] - 2500;
+        if (dx * dx + dy * dy + dz * dz <= 3000.0 * 3000.0) expectInside++;
+    }
+    CHECK(inside.size() == expectInside);
+}
+
+static void testTrajectorySaveReuse() {
+    TrajectoryLogger log(tempPath("saved.csv"));
+    for (int i = 0; i < 10000; i++) log.addPoint(i, 2 * i, 3, 100 + i % 5, i);
+    CHECK(log.saveToCSV());
+    log.addPoint(1, 1, 1, 1, 10000);
+    CHECK(log.saveToCSV());   // тот же писатель, файл перезаписывается
+    TrajectoryLogger loaded(tempPath("saved.csv"));
+    CHECK(loaded.loadFromCSV() && loaded.getLoadErrors().empty());
+    CHECK(loaded.getStatistics().pointCount == 10001);
+}
+
+// ---------- AsyncFileWriter ----------
+
+static void testAsyncFileWriterSyncPolicies() {
+    std::string block(1000, 'x');
+    for (int i = 0; i < 1000; i++) block[i] = static_cast<char>('a' + i % 26);
+    for (bool ring : { true, false }) {
+        for (auto policy : { AsyncFileWriter::SyncPolicy::None, AsyncFileWriter::SyncPolicy::OnClose,
+                 AsyncFileWriter::SyncPolicy::EveryWrite }) {
+            // Маленькие буферы и кольцо: каждая запись занимает буфер, fsync - соседнюю заявку
+            AsyncFileWriter writer(policy, 512, 2, ring);
+            std::string path = tempPath("async_" + std::to_string(ring) + "_" + std::to_string(static_cast<int>(policy)));
+            int a = writer.open(path + ".a");
+            int b = writer.open(path + ".b");
+            CHECK(a >= 0 && b >= 0);
+            for (int i = 0; i < 40; i++) {
+                writer.write(a, block);
+                writer.write(b, block.data(), 100);
+            }
+            bool closed = false;
+            writer.close(a);
+            writer.close(b, [&closed]() { closed = true; });
+            CHECK(writer.flush() && writer.ok());
+            CHECK(closed);
+            std::ifstream in(path + ".a", std::ios::binary);
+            std::string content((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+            std::string expected;
+            for (int i = 0; i < 40; i++) expected += block;
+            CHECK(content == expected);
+            CHECK(std::filesystem::file_size(path + ".b") == 4000);
+        }
+    }
+}
+
+// ---------- TargetManager: индексы по id и приоритету ----------
+
+static void testIdSlotMapErase() {
+    // До 10 ключей в таблице на 16 ячеек: длинные цепочки переходят через
+    // конец таблицы, и удаление сдвигом часто переносит их через край
+    IdSlotMap map;
+    std::map<int, uint32_t> reference;
+    uint64_t state = 7;
+    auto next = [&state]() {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        return static_cast<uint32_t>(state >> 33);
+    };
+    for (int step = 0; step < 200000; step++) {
+        int key = static_cast<int>(next() % 40) - 20;
+        if (reference.size() >= 10 || (next() & 1)) {
+            CHECK(map.erase(key) == (reference.erase(key) == 1));
+        } else {
+            uint32_t value = next();
+            map.set(key, value);
+            reference[key] = value;
+        }
+        CHECK(map.size() == reference.size());
+        if (step % 16 == 0) {
+            for (int k = -20; k < 20; k++) {
+                const uint32_t* found = map.find(k);
+                auto it = reference.find(k);
+                CHECK((found != nullptr) == (it != reference.end()));
+                if (found && it != reference.end()) CHECK(*found == it->second);
+            }
+        }
+    }
+
+    // После роста таблицы и удаления половины ключей остальные на месте
+    IdSlotMap big;
+    for (int k = 0; k < 5000; k++) big.set(k * 7919, static_cast<uint32_t>(k));
+    for (int k = 0; k < 5000; k += 2) CHECK(big.erase(k * 7919));
+    CHECK(big.size() == 2500);
+    for (int k = 0; k < 5000; k++) {
+        const uint32_t* found = big.find(k * 7919);
+        CHECK((found != nullptr) == (k % 2 == 1));
+        if (found) CHECK(*found == static_cast<uint32_t>(k));
+    }
+    CHECK(!big.erase(-1));
+}
+
+static void testPriorityView() {
+    TargetManager tm;
+    for (int i = 0; i < 20; i++) CHECK(tm.addTarget(i, "T" + std::to_string(i), i, 0, 0, i % 5, i));
+
+    // По убыванию приоритета, при равном - по убыванию id; порог включается
+    auto view = tm.getHighPriorityTargets(3);
+    CHECK(view.size() == 8 && !view.empty());
+    std::vector<int> ids;
+    for (const auto& t : view) ids.push_back(t.id);
+    CHECK(ids == std::vector<int>({ 19, 14, 9, 4, 18, 13, 8, 3 }));
+    CHECK(tm.getHighPriorityTargets(4.5).empty());
+    CHECK(tm.getHighPriorityTargets(-1).size() == 20);
+
+    // Замена и удаление переставляют цель в индексе
+    tm.addTarget(0, "top", 0, 0, 0, 10, 0);
+    CHECK(tm.removeTarget(19));
+    CHECK(tm.removeTarget(14));
+    ids.clear();
+    for (const auto& t : tm.getHighPriorityTargets(4)) ids.push_back(t.id);
+    CHECK(ids == std::vector<int>({ 0, 9, 4 }));
+    CHECK((*tm.getHighPriorityTargets(10).begin()).name == "top");
+
+    // NaN и бесконечность отклоняются, прежняя цель остается
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    CHECK(!tm.addTarget(4, "nan", 0, 0, 0, nan, 0));
+    CHECK(!tm.addTarget(50, "inf", 0, 0, 0, std::numeric_limits<double>::infinity(), 0));
+    CHECK(tm.size() == 18);
+    CHECK(tm.findTarget(4) && tm.findTarget(4)->name == "T4" && !tm.findTarget(50));
+    CHECK(tm.removeTarget(4));
+    CHECK(tm.getHighPriorityTargets(4).size() == 2);
+
+    tm.publish();
+    auto snap = tm.snapshot();
+    CHECK(snap->countAtLeast(4) == 2);
+    CHECK(snap->byPriority(0).id == 0 && snap->byPriority(1).id == 9);
+    CHECK(snap->countAtLeast(-1) == tm.size());
+}
+
+// ---------- RadixSorter ----------
+
+// Порядок IEEE totalOrder: -NaN < -inf < ... < -0.0 < +0.0 < ... < +inf < +NaN
+static bool totalOrderLess(double a, double b) {
+    auto group = [](double v) { return std::isnan(v) ? (std::signbit(v) ? 0 : 2) : 1; };
+    if (group(a) != group(b)) return group(a) < group(b);
+    if (group(a) != 1) return false;
+    if (a != b) return a < b;
+    return std::signbit(a) && !std::signbit(b);
+}
+
+static void testRadixSorterMatchesStableSort() {
+    const double inf = std::numeric_limits<double>::infinity();
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    const double special[] = { 0.0, -0.0, inf, -inf, nan, -nan, 1e-310, -1e-310, 1.0, -1.0 };
+    uint64_t state = 11;
+    auto next = [&state]() {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        return state >> 11;
+    };
+    RadixSorter sorter;
+    // По обе стороны от 64: ветка stable_sort и восьмипроходная LSD
+    for (size_t n : { 0, 1, 2, 17, 63, 64, 65, 200, 4096 }) {
+        std::vector<double> values(n);
+        for (auto& v : values) {
+            uint64_t pick = next() % 4;
+            if (pick == 0) v = special[next() % 10];
+            else if (pick == 1) v = static_cast<double>(next() % 5) - 2.0;   // повторы
+            else v = (static_cast<double>(next() % 2000001) - 1000000.0) * 1.5e3;
+        }
+        std::vector<uint32_t> expected(n);
+        for (size_t i = 0; i < n; i++) expected[i] = static_cast<uint32_t>(i);
+        std::stable_sort(expected.begin(), expected.end(),
+            [&](uint32_t a, uint32_t b) { return totalOrderLess(values[a], values[b]); });
+        CHECK(sorter.sort(values.data(), n) == expected);
+    }
+
+    // Ключи, различные только в младших байтах, и одинаковые ключи
+    std::vector<double> close(300);
+    for (size_t i = 0; i < close.size(); i++) close[i] = 1.0 + (close.size() - i) * 1e-15;
+    const auto& order = sorter.sort(close.data(), close.size());
+    for (size_t i = 0; i < order.size(); i++) CHECK(order[i] == close.size() - 1 - i);
+    std::vector<double> same(100, -3.25);
+    const auto& identity = sorter.sort(same.data(), same.size());
+    for (size_t i = 0; i < identity.size(); i++) CHECK(identity[i] == i);
+}
+
+// ---------- TargetManager: снимки для читателей ----------
+
+static void testSnapshotReadersWhileWriting() {
+    const int count = 200;
+    const int rounds = 400;
+    TargetManager tm(10.0);
+    // Раунд r: все цели с x = r и именем "r<r>", часть удаляется и добавляется заново
+    auto fillRound = [&](int r) {
+        std::string name = "r" + std::to_string(r);
+        for (int id = 0; id < count; id++) tm.addTarget(id, name, r, id, 0, id % 10, id);
+        for (int k = 0; k < 5; k++) {
+            int id = (r * 7 + k) % count;
+            tm.removeTarget(id);
+            tm.addTarget(id, name, r, id, 0, id % 10, id);
+        }
+    };
+    fillRound(0);
+    tm.publish();
+    auto first = tm.snapshot();
+
+    std::atomic<bool> done{ false };
+    std::atomic<int> broken{ 0 };
+    std::atomic<int> reacquired{ 0 };
+    std::thread writer([&]() {
+        for (int r = 1; r <= rounds; r++) {
+            fillRound(r);
+            tm.publish();
+        }
+        done = true;
+    });
+
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; t++) {
+        readers.emplace_back([&]() {
+            TargetManager::SnapshotReader reader(tm);
+            uint64_t lastVersion = 0;
+            double lastRound = -1;
+            int versions = 0;
+            for (bool finished = false; !finished;) {
+                finished = done;
+                const TargetManager::Snapshot& snap = reader.current();
+                if (snap.version() != lastVersion) versions++;
+                bool ok = snap.version() >= lastVersion && snap.size() == static_cast<size_t>(count);
+                double round = ok ? snap.at(0).x : 0;
+                std::string name = "r" + std::to_string(static_cast<int>(round));
+                ok = ok && round >= lastRound;
+                for (size_t i = 0; ok && i < snap.size(); i++) {
+                    TargetManager::Target t = snap.at(i);
+                    ok = t.x == round && t.name == name && snap.find(t.id) && snap.find(t.id)->y == t.id;
+                }
+                size_t high = snap.countAtLeast(5);
+                ok = ok && high == static_cast<size_t>(count / 2);
+                for (size_t rank = 0; ok && rank < snap.size(); rank++) {
+                    double pr = snap.byPriority(rank).priority;
+                    ok = (rank < high) == (pr >= 5) &&
+                        (rank == 0 || snap.byPriority(rank - 1).priority >= pr);
+                }
+                auto hit = snap.nearest(1, round, 3, 0);
+                ok = ok && hit.size() == 1 && hit[0].id == 3 && hit[0].distance == 0;
+                if (!ok) broken++;
+                lastVersion = snap.version();
+                lastRound = round;
+            }
+            // Последняя публикация видна после остановки писателя
+            if (reader.current().version() != static_cast<uint64_t>(rounds + 1)) broken++;
+            reacquired += versions;
+        });
+    }
+    writer.join();
+    for (auto& r : readers) r.join();
+    CHECK(broken == 0);
+    CHECK(reacquired > 4);
+
+    // Старый снимок не меняется после сотен публикаций и чистки пула имен
+    CHECK(first->version() == 1 && first->size() == static_cast<size_t>(count));
+    for (size_t i = 0; i < first->size(); i++) {
+        CHECK(first->at(i).x == 0 && first->at(i).name == "r0");
+    }
+    CHECK(tm.snapshot()->version() == static_cast<uint64_t>(rounds + 1));
+}
+
+// ---------- TargetManager: журнал и снимок ----------
+
+static void testTargetJournalRecovery() {
+    std::string base = tempPath("targets");
+    {
+        TargetManager tm;
+        CHECK(tm.openJournal(base));
+        for (int i = 0; i < 50; i++) tm.addTarget(i, "T" + std::to_string(i), i, 2.0 * i, 100, i % 7, 10.0 * i);
+        CHECK(tm.compact());
+        CHECK(tm.removeTarget(7));
+        tm.addTarget(3, "renamed", 1, 1, 1, 9, 5);
+    }
+    // Снимок + хвост журнала; оборванная запись в конце отбрасывается
+    {
+        std::ofstream tail(base + ".journal", std::ios::binary | std::ios::app);
+        tail.write("\x01\x40\x00", 3);
+    }
+    TargetManager tm;
+    CHECK(tm.openJournal(base));
+    CHECK(tm.size() == 49);
+    CHECK(!tm.findTarget(7));
+    auto renamed = tm.findTarget(3);
+    CHECK(renamed && renamed->name == "renamed" && renamed->priority == 9);
+
+    // Порча снимка: openJournal отказывает и не трогает текущее состояние
+    std::string other = tempPath("broken");
+    {
+        TargetManager writer;
+        CHECK(writer.openJournal(other));
+        writer.addTarget(1, "A", 0, 0, 0, 1, 1);
+        CHECK(writer.compact());
+    }
+    {
+        std::fstream snap(other + ".snap", std::ios::binary | std::ios::in | std::ios::out);
+        snap.seekp(-1, std::ios::end);
+        snap.put('\x7f');
+    }
+    CHECK(!tm.openJournal(other));
+    CHECK(tm.size() == 49);
+    CHECK(tm.findTarget(3) && tm.findTarget(3)->name == "renamed");
+    CHECK(tm.nearest(1, 10, 20, 100).size() == 1);
+    // Журнал остался прежним: новые изменения попадают в base
+    tm.addTarget(100, "after", 0, 0, 0, 0, 0);
+    TargetManager reopened;
+    CHECK(reopened.openJournal(base));
+    CHECK(reopened.size() == 50 && reopened.findTarget(100));
+}
+
+static void testTargetNamePoolChurn() {
+    TargetManager tm;
+    for (int i = 0; i < 100000; i++) {
+        tm.addTarget(i % 10, "name-" + std::to_string(i), i % 10, 0, 0, i % 5, 1);
+        if (i % 3 == 0) tm.removeTarget((i + 5) % 10);
+    }
+    // Пул ограничен числом живых целей, а не числом когда-либо виденных имен
+    CHECK(tm.nameCount() <= 2 * tm.size() + 1025);
+    for (int id = 0; id < 10; id++) {
+        auto t = tm.findTarget(id);
+        if (t) CHECK(t->name.substr(0, 5) == "name-");
+    }
+    // Опубликованный снимок держит старый пул и после чистки
+    tm.publish();
+    auto view = tm.snapshot();
+    tm.compact();
+    CHECK(tm.nameCount() <= tm.size());
+    CHECK(view->size() == tm.size());
+    for (size_t i = 0; i < view->size(); i++) CHECK(view->at(i).name.substr(0, 5) == "name-");
+}
+
+// ---------- Очередь телеметрии ----------
+
+static void testMpscRingOrderAndCapacity() {
+    MpscRing<uint64_t> ring(5);
+    CHECK(ring.capacity() == 8);
+    for (uint64_t i = 0; i < 8; i++) CHECK(ring.tryPush(i));
+    CHECK(!ring.tryPush(8));
+    uint64_t v = 0;
+    CHECK(ring.tryPop(v) && v == 0);
+    CHECK(ring.tryPush(8));
+
+    // Несколько писателей: записи каждого приходят по порядку, ничего не теряется
+    MpscRing<uint64_t> shared(64);
+    const int producers = 4;
+    const uint64_t perProducer = 20000;
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; p++) {
+        threads.emplace_back([&shared, p, perProducer]() {
+            for (uint64_t i = 0; i < perProducer; i++) {
+                while (!shared.tryPush((static_cast<uint64_t>(p) << 32) | i)) std::this_thread::yield();
+            }
+        });
+    }
+    std::vector<uint64_t> next(producers, 0);
+    uint64_t received = 0;
+    bool ordered = true;
+    while (received < producers * perProducer) {
+        if (!shared.tryPop(v)) {
+            std::this_thread::yield();
+            continue;
+        }
+        size_t p = static_cast<size_t>(v >> 32);
+        if (p >= next.size() || (v & 0xFFFFFFFFu) != next[p]) ordered = false;
+        else next[p]++;
+        received++;
+    }
+    for (auto& t : threads) t.join();
+    CHECK(ordered);
+    CHECK(!shared.tryPop(v));
+}
+
+static void testTelemetryLoggerConcurrentWriters() {
+    TelemetrySummary summary;
+    uint64_t accepted = 0;
+    {
+        TelemetryLogger logger(1 << 13);   // больше всех записей: отбрасываний нет
+        std::atomic<uint64_t> ok{ 0 };
+        std::vector<std::thread> threads;
+        for (int p = 0; p < 3; p++) {
+            threads.emplace_back([&logger, &ok, p]() {
+                for (int i = 0; i < 2500; i++) {
+                    if (logger.logData(p * 10000.0 + i, 1000, 200, 90, 50)) ok++;
+                }
+            });
+        }
+        for (auto& t : threads) t.join();
+        logger.rotateFileIfNeeded();
+        accepted = ok.load();
+        CHECK(accepted == 7500 && logger.droppedCount() == 0);
+        summary = logger.summarize(2);
+    }
+    CHECK(summary.records == accepted && summary.unreadable == 0);
+    CHECK(summary.timeMin == 0 && summary.timeMax == 22499);
+}
+
+// Сводка во время записи: счетчик не убывает, записи не теряются и не удваиваются
+static void testTelemetrySummaryWhileLogging() {
+    const int total = 20000;
+    TelemetryLogger logger(1 << 15);
+    std::atomic<bool> done{ false };
+    std::thread producer([&]() {
+        for (int i = 0; i < total; i++) {
+            logger.logData(i, 1000, 200, 90, 50);
+            if (i % 500 == 0) std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+        done = true;
+    });
+    uint64_t last = 0;
+    bool monotonic = true;
+    int summaries = 0;
+    while (!done) {
+        TelemetrySummary s = logger.summarize(2);
+        if (s.records < last || s.records > static_cast<uint64_t>(total)) monotonic = false;
+        last = s.records;
+        summaries++;
+    }
+    producer.join();
+    logger.rotateFileIfNeeded();
+    TelemetrySummary s = logger.summarize(2);
+    CHECK(monotonic && summaries > 0);
+    CHECK(logger.droppedCount() == 0 && s.records == static_cast<uint64_t>(total));
+    CHECK(s.timeMin == 0 && s.timeMax == total - 1 && s.unreadable == 0);
+}
+
+// ---------- Файлы телеметрии ----------
+
+static std::vector<TelemetryData> makeTelemetry(size_t n, double t0) {
+    std::vector<TelemetryData> data;
+    for (size_t i = 0; i < n; i++) {
+        double t = t0 + 0.1 * static_cast<double>(i);
+        data.push_back({ t, 1000 + std::sin(t), 200.0 + static_cast<double>(i % 7), std::fmod(3.0 * t, 360.0), 100 - 0.01 * t });
+    }
+    return data;
+}
+
+static void writeTelemetryFile(const std::string& path, const std::vector<TelemetryData>& data, bool withHeader) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (withHeader) {
+        TelemetryFileHeader h = TelemetryFileHeader::make(data.data(), data.size());
+        out.write(reinterpret_cast<const char*>(&h), sizeof h);
+    }
+    out.write(reinterpret_cast<const char*>(data.data()), data.size() * sizeof(TelemetryData));
+}
+
+static bool sameTelemetry(const TelemetryData& a, const TelemetryData& b) {
+    return std::memcmp(&a, &b, sizeof a) == 0;
+}
+
+static void testTelemetryFileFormats() {
+    auto data = makeTelemetry(300, 5.0);
+    std::string path = tempPath("tf_1.bin");
+    writeTelemetryFile(path, data, true);
+    TelemetryFile file;
+    CHECK(file.open(path));
+    CHECK(file.header() && file.header()->recordCount == 300 && !file.compressed());
+    CHECK(file.header()->timeMin == 5.0 && file.header()->timeMax == data.back().time);
+    CHECK(file.records().size() == 300 && sameTelemetry(file.records()[299], data[299]));
+
+    // Файл без заголовка читается как голые записи
+    std::string legacy = tempPath("tf_2.bin");
+    writeTelemetryFile(legacy, data, false);
+    CHECK(file.open(legacy) && !file.header() && file.records().size() == 300);
+
+    // Обрезанный файл и чужой размер записи отвергаются
+    std::filesystem::resize_file(path, sizeof(TelemetryFileHeader) + 10 * sizeof(TelemetryData));
+    CHECK(!file.open(path) && !file.lastError().empty());
+    writeTelemetryFile(path, data, true);
+    {
+        std::fstream f(path, std::ios::binary | std::ios::in | std::ios::out);
+        uint32_t wrongSize = 48;
+        f.seekp(offsetof(TelemetryFileHeader, recordSize));
+        f.write(reinterpret_cast<const char*>(&wrongSize), sizeof wrongSize);
+    }
+    CHECK(!file.open(path));
+
+    // Архив обходит файлы по номеру (2 раньше 10) и пропускает нечитаемые
+    writeTelemetryFile(tempPath("arch_10.bin"), makeTelemetry(3, 100), true);
+    writeTelemetryFile(tempPath("arch_2.bin"), makeTelemetry(2, 0), true);
+    writeText(tempPath("arch_5.bin"), "TLMLOG\r\n broken");
+    writeText(tempPath("arch_x.bin"), "ignored");
+    TelemetryArchive archive("arch", workDir.string());
+    CHECK(archive.fileCount() == 3 && archive.number(0) == 2 && archive.number(2) == 10);
+    std::vector<double> times;
+    for (const auto& d : archive) times.push_back(d.time);
+    CHECK((times == std::vector<double>{ 0, 0.1, 100, 100.1, 100.2 }));
+}
+
+static bool gorillaRoundTrip(const std::vector<TelemetryData>& data, bool expectTicks) {
+    std::string encoded;
+    BitWriter bits;
+    GorillaCodec::encodeBlock(data.data(), data.size(), encoded, bits);
+    TelemetryBlockHeader bh;
+    std::memcpy(&bh, encoded.data(), sizeof bh);
+    bool ticks = (bh.flags & TelemetryBlockHeader::FLAG_TICKS) != 0;
+    // Буфер слов выровнен, как в отображенном файле
+    std::vector<uint64_t> aligned((encoded.size() + 7) / 8);
+    std::memcpy(aligned.data(), encoded.data(), encoded.size());
+    std::vector<TelemetryData> out;
+    if (ticks != expectTicks || !GorillaCodec::decodeBlock(*reinterpret_cast<const TelemetryBlockHeader*>(aligned.data()), out)) return false;
+    if (out.size() != data.size()) return false;
+    for (size_t i = 0; i < data.size(); i++) {
+        if (!sameTelemetry(out[i], data[i])) return false;
+    }
+    return true;
+}
+
+// Время, которое декодер получит делением целых микросекунд
+static std::vector<TelemetryData> makeTickTelemetry(size_t n) {
+    auto data = makeTelemetry(n, 0.0);
+    for (size_t i = 0; i < n; i++) data[i].time = static_cast<double>(100000 * static_cast<int64_t>(i) + (i % 3)) / 1e6;
+    return data;
+}
+
+static void testGorillaRoundTrip() {
+    // Время кратно микросекундам: разности разностей
+    CHECK(gorillaRoundTrip(makeTickTelemetry(256), true));
+    // 0.1 * i микросекундами точно не выражается
+    CHECK(gorillaRoundTrip(makeTelemetry(256, 0.0), false));
+    // -0.0 и время не в микросекундах: побитово через XOR
+    auto negZero = makeTelemetry(10, 0.0);
+    negZero[0].time = -0.0;
+    CHECK(gorillaRoundTrip(negZero, false));
+    auto fine = makeTelemetry(50, 1.0);
+    for (size_t i = 0; i < fine.size(); i++) fine[i].time = 1.0 / 3.0 + 1e-7 * static_cast<double>(i);
+    CHECK(gorillaRoundTrip(fine, false));
+    // Нечисловые значения и большие скачки времени
+    auto odd = makeTickTelemetry(20);
+    odd[3].altitude = std::numeric_limits<double>::quiet_NaN();
+    odd[4].speed = -std::numeric_limits<double>::infinity();
+    odd[5].fuel = -0.0;
+    odd[6].time = 9e11;
+    odd[7].time = -9e11;
+    CHECK(gorillaRoundTrip(odd, true));
+    odd[8].time = std::numeric_limits<double>::quiet_NaN();
+    CHECK(gorillaRoundTrip(odd, false));
+    CHECK(gorillaRoundTrip(makeTelemetry(1, 42.5), true));
+}
+
+// ---------- Каталог и поиск по времени ----------
+
+static void testTelemetryCatalogStaleness() {
+    {
+        TelemetryLogger logger;
+        for (int i = 0; i < 2500; i++) logger.logData(i, 1000, 200, 90, 50);
+        logger.rotateFileIfNeeded();
+    }
+    CHECK(std::filesystem::exists("telemetry.catalog"));
+    TelemetryIndex index;
+    CHECK(index.fileCount() == 3);
+    auto hits = index.range(999.5, 1009.5);
+    CHECK(hits.size() == 10 && hits.front().time == 1000 && hits.back().altitude == 1000);
+    CHECK(index.query(1200, 1300, [](const TelemetryData&) {}) == 1);
+
+    // Файл переписан тем же числом записей того же размера: по каталогу
+    // блоки и время были бы старыми, индекс должен заметить изменение
+    auto replaced = makeTelemetry(1000, 5000.0);
+    for (size_t i = 0; i < replaced.size(); i++) replaced[i].time = 5000.0 + static_cast<double>(i);
+    auto sizeBefore = std::filesystem::file_size("telemetry_2.bin");
+    writeTelemetryFile("telemetry_2.bin", replaced, true);
+    CHECK(std::filesystem::file_size("telemetry_2.bin") == sizeBefore);
+    std::filesystem::last_write_time("telemetry_2.bin",
+        std::filesystem::last_write_time("telemetry_2.bin") + std::chrono::seconds(5));
+    TelemetryIndex reindexed;
+    CHECK(reindexed.range(1000, 1999).empty());
+    auto moved = reindexed.range(5000, 5009);
+    CHECK(moved.size() == 10 && moved[3].time == 5003);
+
+    // Изменение после построения индекса: старые смещения блоков не используются
+    writeTelemetryFile("telemetry_3.bin", makeTelemetry(10, 7000.0), true);
+    CHECK(reindexed.range(2000, 2499).empty());
+    TelemetryIndex again;
+    CHECK(again.range(7000, 7001).size() == 10 && again.range(2000, 2499).empty());
+}
+
+// Каждая проверка работает в своем подкаталоге: часть классов пишет файлы в текущий каталог
+// ---------- Агрегаты телеметрии ----------
+
+static void testTelemetryRollups() {
+    // Шаг 0.7 с: интервалы 10 с и 1 мин разрезаются границами файлов
+    const int n = 2500;
+    {
+        TelemetryLogger logger;
+        for (int i = 0; i < n; i++) logger.logData(0.7 * i, i, 200, i % 360, 100 - 0.01 * i);
+        logger.rotateFileIfNeeded();
+    }
+    TelemetryRollups rollups;
+    CHECK(rollups.fileCount() == 3);
+
+    for (auto level : { TelemetryRollups::Second, TelemetryRollups::TenSeconds, TelemetryRollups::Minute }) {
+        double width = TelemetryRollupHeader::WIDTHS[level];
+        auto buckets = rollups.buckets(level, 0, 1e9);
+        std::map<int64_t, std::vector<int>> expected;
+        for (int i = 0; i < n; i++) expected[static_cast<int64_t>(std::floor(0.7 * i / width))].push_back(i);
+        CHECK(buckets.size() == expected.size());
+        size_t k = 0;
+        for (const auto& e : expected) {
+            if (k >= buckets.size()) break;
+            const auto& b = buckets[k++];
+            const auto& ids = e.second;
+            double mean = 0;
+            for (int i : ids) mean += i;
+            mean /= ids.size();
+            CHECK(b.start == e.first * width && b.count == ids.size());
+            CHECK(b.min[0] == ids.front() && b.max[0] == ids.back() && b.last[0] == ids.back());
+            CHECK(std::fabs(b.mean[0] - mean) < 1e-9 * std::max(1.0, mean));
+            CHECK(b.lastTime == 0.7 * ids.back());
+        }
+    }
+
+    TelemetryRollupBucket all = rollups.total(0, 1e9);
+    CHECK(all.count == static_cast<uint64_t>(n) && all.min[0] == 0 && all.max[0] == n - 1);
+    CHECK(std::fabs(all.mean[0] - (n - 1) / 2.0) < 1e-9 * n);
+    auto middle = rollups.buckets(TelemetryRollups::Minute, 600, 1200);
+    CHECK(middle.size() == 11 && middle.front().start == 600 && middle.back().start == 1200);
+
+    // Поврежденный файл агрегатов пропускается, остальные читаются
+    std::filesystem::resize_file("telemetry_2.rollup", 40);
+    TelemetryRollupBucket partial = TelemetryRollups().total(0, 1e9);
+    CHECK(partial.count == static_cast<uint64_t>(n - 1000));
+}
+
+// ---------- Живая телеметрия в разделяемой памяти ----------
+
+#ifndef _WIN32
+// Писатель в дочернем процессе публикует count записей и завершается без деструкторов
+static void crashedWriter(const std::string& name, size_t capacity, int count) {
+    pid_t pid = fork();
+    if (pid == 0) {
+        auto* ring = new LiveTelemetryRing(name, capacity);
+        for (int i = 0; i < count; i++) ring->publish({ static_cast<double>(i), 0, 0, 0, 0 });
+        _exit(ring->isOpen() ? 0 : 1);
+    }
+    int status = 0;
+    waitpid(pid, &status, 0);
+    CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+}
+
+static void testLiveTelemetryRing() {
+    std::string name = "sem6_live_" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count());
+    CHECK(!LiveTelemetryRing(name, 0).isOpen());
+    {
+        TelemetryLogger logger;
+        CHECK(!logger.enableLiveRing(name, 0));
+    }
+
+    {
+        LiveTelemetryRing writer(name, 4);
+        CHECK(writer.isOpen());
+        CHECK(!LiveTelemetryRing(name, 4).isOpen());   // второй писатель
+        LiveTelemetryReader reader(name);
+        CHECK(reader.isOpen() && reader.capacity() == 4);
+        for (int i = 0; i < 6; i++) writer.publish({ static_cast<double>(i), 1, 2, 3, 4 });
+        uint64_t cursor = 0;
+        std::vector<TelemetryData> got;
+        CHECK(reader.readSince(cursor, got) == 2);
+        CHECK(cursor == 6 && got.size() == 4 && got.front().time == 2 && got.back().time == 5);
+    }
+    CHECK(!LiveTelemetryReader(name).isOpen());   // писатель удалил сегмент
+
+    // Сегмент упавшего писателя: той же емкости - продолжается, читатель ничего не теряет
+    crashedWriter(name, 8, 3);
+    LiveTelemetryReader before(name);
+    CHECK(before.isOpen() && before.published() == 3);
+    {
+        LiveTelemetryRing resumed(name, 8);
+        CHECK(resumed.isOpen());
+        resumed.publish({ 3, 0, 0, 0, 0 });
+        TelemetryData d{};
+        CHECK(before.published() == 4 && before.read(0, d) && d.time == 0 && before.read(3, d) && d.time == 3);
+    }
+
+    // Другой емкости - новый сегмент; старые читатели дочитывают прежнюю память
+    crashedWriter(name, 8, 5);
+    LiveTelemetryReader stale(name);
+    {
+        LiveTelemetryRing replaced(name, 16);
+        CHECK(replaced.isOpen());
+        LiveTelemetryReader fresh(name);
+        CHECK(fresh.isOpen() && fresh.capacity() == 16 && fresh.published() == 0);
+        TelemetryData d{};
+        CHECK(stale.published() == 5 && stale.read(4, d) && d.time == 4);
+    }
+}
+#else
+static void testLiveTelemetryRing() {}
+#endif
+
+// ---------- Маршрут: BVH участков и прохождение точек ----------
+
+static double bruteLegDistance(const std::vector<double>& xs, const std::vector<double>& ys,
+    const std::vector<double>& zs, size_t leg, double x, double y, double z) {
+    double dx = xs[leg + 1] - xs[leg], dy = ys[leg + 1] - ys[leg], dz = zs[leg + 1] - zs[leg];
+    double len2 = dx * dx + dy * dy + dz * dz;
+    double t = len2 > 0 ? ((x - xs[leg]) * dx + (y - ys[leg]) * dy + (z - zs[leg]) * dz) / len2 : 0.0;
+    t = std::clamp(t, 0.0, 1.0);
+    double ex = xs[leg] + t * dx - x, ey = ys[leg] + t * dy - y, ez = zs[leg] + t * dz - z;
+    return std::sqrt(ex * ex + ey * ey + ez * ez);
+}
+
+static void testRouteSegmentIndex() {
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<double> step(-800, 800), coord(-20000, 20000);
+    std::vector<double> xs{ 0 }, ys{ 0 }, zs{ 1000 };
+    for (int i = 0; i < 600; i++) {
+        xs.push_back(xs.back() + step(rng));
+        ys.push_back(ys.back() + step(rng));
+        zs.push_back(zs.back() + step(rng) / 10);
+    }
+    xs.push_back(xs.back());   // участок нулевой длины
+    ys.push_back(ys.back());
+    zs.push_back(zs.back());
+    RouteSegmentIndex index;
+    index.build(xs, ys, zs);
+    CHECK(index.legCount() == xs.size() - 1);
+    bool agree = true;
+    for (int q = 0; q < 300; q++) {
+        double x = coord(rng), y = coord(rng), z = coord(rng) / 10;
+        size_t first = q % 3 == 0 ? static_cast<size_t>(q) : 0;
+        size_t last = q % 3 == 1 ? first + 20 : SIZE_MAX;
+        auto hit = index.nearestSegment(x, y, z, first, last);
+        double best = INFINITY;
+        for (size_t leg = first; leg < index.legCount() && leg <= last; leg++) {
+            best = std::min(best, bruteLegDistance(xs, ys, zs, leg, x, y, z));
+        }
+        if (!hit.valid() || std::fabs(hit.crossTrack - best) > 1e-6 ||
+            std::fabs(bruteLegDistance(xs, ys, zs, hit.leg, x, y, z) - best) > 1e-6) agree = false;
+    }
+    CHECK(agree);
+    CHECK(!index.nearestSegment(0, 0, 0, index.legCount()).valid());
+    auto onLeg = index.nearestSegment(0.5 * (xs[3] + xs[4]), 0.5 * (ys[3] + ys[4]), 0.5 * (zs[3] + zs[4]));
+    CHECK(onLeg.crossTrack < 1e-6);
+}
+
+static void testWaypointOutAndBack() {
+    // A -> B -> C -> B2 -> D: обратный участок идет в 20 м от прямого
+    WaypointManager route;
+    route.addWaypoint(0, 0, 0, 0, 100, "A");
+    route.addWaypoint(1, 1000, 0, 0, 100, "B");
+    route.addWaypoint(2, 2000, 0, 0, 100, "C");
+    route.addWaypoint(3, 1000, 20, 0, 100, "B2");
+    route.addWaypoint(4, 0, 20, 0, 100, "D");
+    CHECK(route.checkWaypointReached(0, 0, 0) && route.getCurrentIndex() == 1);
+    CHECK(route.checkWaypointReached(1000, 3, 0) && route.getCurrentIndex() == 2);
+    // На пути к C позиция ближе к обратному участку, но C еще не пройдена
+    CHECK(!route.checkWaypointReached(1500, 12, 0));
+    CHECK(route.getCurrentIndex() == 2);
+    // Пролет C по проекции
+    CHECK(route.checkWaypointReached(2003, 5, 0) && route.getCurrentIndex() == 3);
+    // Возвращаемся мимо B2 с пролетом: за вызов - одна точка
+    CHECK(route.checkWaypointReached(900, 20, 0) && route.getCurrentIndex() == 4);
+    CHECK(!route.checkWaypointReached(900, 20, 0));
+    CHECK(route.checkWaypointReached(1, 20, 0) && route.getCurrentIndex() == 5);
+    CHECK(!route.checkWaypointReached(0, 20, 0));
+
+    // Срезанный угол: далеко от активного участка и в коридоре следующего
+    WaypointManager corner;
+    corner.addWaypoint(0, 0, 0, 0, 100, "A");
+    corner.addWaypoint(1, 1000, 0, 0, 100, "B");
+    corner.addWaypoint(2, 1000, 1000, 0, 100, "C");
+    CHECK(corner.checkWaypointReached(0, 0, 0));
+    CHECK(!corner.checkWaypointReached(900, 0, 0));
+    CHECK(corner.checkWaypointReached(1010, 300, 0) && corner.getCurrentIndex() == 2);
+
+    // Полет вдоль маршрута мелкими шагами: индекс растет по одному и не обгоняет позицию
+    WaypointManager flown;
+    const double pts[5][2] = { { 0, 0 }, { 1000, 0 }, { 2000, 0 }, { 1000, 20 }, { 0, 20 } };
+    for (int k = 0; k < 5; k++) flown.addWaypoint(k, pts[k][0], pts[k][1], 0, 100, "");
+    bool inOrder = true;
+    for (int leg = 0; leg < 4; leg++) {
+        for (int s = 0; s <= 100; s++) {
+            double t = s / 100.0;
+            size_t before = flown.getCurrentIndex();
+            flown.checkWaypointReached(pts[leg][0] + t * (pts[leg + 1][0] - pts[leg][0]),
+                pts[leg][1] + t * (pts[leg + 1][1] - pts[leg][1]), 0);
+            size_t after = flown.getCurrentIndex();
+            if (after > before + 1 || after > static_cast<size_t>(leg) + 2) inOrder = false;
+        }
+    }
+    CHECK(inOrder && flown.getCurrentIndex() == 5);
+}
+
+// ---------- Оптимизация порядка облета ----------
+
+static bool isRoutePermutation(const std::vector<uint32_t>& route, size_t n) {
+    if (route.size() != n || route.empty() || route[0] != 0) return false;
+    std::vector<char> seen(n, 0);
+    for (uint32_t v : route) {
+        if (v >= n || seen[v]) return false;
+        seen[v] = 1;
+    }
+    return true;
+}
+
+static void testRouteOptimizer() {
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<double> coord(0, 10000);
+    std::vector<double> xs, ys, zs;
+    for (int i = 0; i < 400; i++) {
+        xs.push_back(coord(rng));
+        ys.push_back(coord(rng));
+        zs.push_back(coord(rng) / 20);
+    }
+    RouteOptimizer optimizer(xs, ys, zs);
+    auto single = optimizer.run(6, 1);
+    auto parallel = optimizer.run(6, 4);
+    CHECK(isRoutePermutation(single.route, xs.size()));
+    CHECK(single.route == parallel.route && single.length == parallel.length);
+    CHECK(std::fabs(optimizer.length(single.route) - single.length) < 1e-6);
+    // Значения по умолчанию не зависят от числа ядер
+    CHECK(optimizer.run().route == optimizer.run(0, 1).route);
+    // Улучшение не хуже чистого ближайшего соседа
+    CHECK(single.length <= optimizer.solve(0).length + 1e-9);
+
+    // Точки на прямой: оптимум - обход по порядку
+    std::vector<double> lx, ly, lz;
+    for (int i = 0; i < 30; i++) {
+        lx.push_back((i * 7) % 30);
+        ly.push_back(0);
+        lz.push_back(0);
+    }
+    lx[0] = -1;
+    auto line = RouteOptimizer(lx, ly, lz).run(2, 2);
+    CHECK(isRoutePermutation(line.route, lx.size()) && std::fabs(line.length - 30) < 1e-9);
+
+    // Мелкие и некорректные входы
+    CHECK(RouteOptimizer({ 0 }, { 0 }, { 0 }).run(1, 1).route == std::vector<uint32_t>{ 0 });
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    auto withNaN = RouteOptimizer({ 0, 1, nan, 3 }, { 0, 0, 0, nan }, { 0, 0, 0, 0 }).run(2, 2);
+    CHECK(isRoutePermutation(withNaN.route, 4));
+}
+
+// ---------- Проверка данных ----------
+
+static void testDataValidator() {
+    using V = DataValidator;
+    V validator;
+    CHECK(!validator.addValidationRule("altitude", 0, 1));
+    CHECK(validator.addValidationRule("z", 0, 20000));
+    CHECK(validator.addValidationRule("speed", 0, 500));
+
+    // Пачка не кратна 64; нарушения, NaN и границы диапазона
+    const size_t n = 150;
+    std::vector<double> z(n), speed(n), x(n, -1e9);   // правила для x нет
+    for (size_t i = 0; i < n; i++) {
+        z[i] = static_cast<double>(i) * 100;
+        speed[i] = static_cast<double>(i % 10) * 60;   // 540 вне диапазона
+    }
+    z[7] = -1;
+    z[130] = std::numeric_limits<double>::quiet_NaN();
+    speed[7] = 600;
+    z[20] = 20000;
+    V::Columns c;
+    c.field[V::X] = x.data();
+    c.field[V::Z] = z.data();
+    c.field[V::SPEED] = speed.data();
+    c.count = n;
+    uint64_t masks[3] = {};
+    size_t bad = validator.validateBatch(c, masks);
+
+    size_t expectBad = 0;
+    bool masksMatch = true;
+    for (size_t i = 0; i < n; i++) {
+        bool invalid = !(z[i] >= 0 && z[i] <= 20000) || !(speed[i] >= 0 && speed[i] <= 500);
+        expectBad += invalid;
+        if (((masks[i / 64] >> (i % 64)) & 1) != static_cast<uint64_t>(invalid)) masksMatch = false;
+    }
+    CHECK(masksMatch && bad == expectBad);
+    CHECK(validator.recordCount() == n && validator.invalidCount() == expectBad);
+    CHECK(validator.violationCount(V::Z) == 2 && validator.checkedCount(V::X) == 0);
+    CHECK(validator.firstViolations().size() == V::MAX_SAMPLES);
+    CHECK(validator.firstViolations().front().record == 7);
+
+    // Каждая проверка отдельного значения - одна запись, без примеров
+    uint64_t checkedSpeed = validator.checkedCount(V::SPEED);
+    uint64_t speedViolations = validator.violationCount(V::SPEED);
+    CHECK(validator.validateSpeed(100));
+    CHECK(!validator.validateSpeed(-5));
+    CHECK(!validator.validateCoordinates(0, 0, 30000));
+    CHECK(validator.validateAcceleration(1e9));   // правила нет
+    CHECK(validator.recordCount() == n + 4 && validator.invalidCount() == expectBad + 2);
+    CHECK(validator.checkedCount(V::SPEED) == checkedSpeed + 2);
+    CHECK(validator.violationCount(V::SPEED) == speedViolations + 1);
+    CHECK(validator.firstViolations().size() == V::MAX_SAMPLES);
+    CHECK(std::fabs(validator.getValidationScore() - double(n + 2 - expectBad) / (n + 4)) < 1e-12);
+
+    // Только отдельные проверки: оценка - доля прошедших
+    V scalar;
+    scalar.addValidationRule("speed", 0, 300);
+    scalar.addValidationRule("z", 0, 5000);
+    CHECK(!scalar.validateSpeed(400) && !scalar.validateCoordinates(0, 0, 6000));
+    CHECK(scalar.getValidationScore() == 0.0);
+    CHECK(scalar.validateSpeed(100) && scalar.validateSpeed(200));
+    CHECK(scalar.getValidationScore() == 0.5);
+    CHECK(scalar.firstViolations().empty());
+
+    // Следующая пачка продолжает нумерацию записей
+    validator.reset();
+    double one[1] = { -3 };
+    V::Columns single;
+    single.field[V::Z] = one;
+    single.count = 1;
+    validator.validateBatch(c);
+    CHECK(validator.validateBatch(single) == 1);
+    CHECK(validator.recordCount() == n + 1);
+}
+
+static void run(const char* name, void (*test)()) {
+    static int counter = 0;
+    std::filesystem::path dir = workDir / ("case_" + std::to_string(++counter));
+    std::filesystem::create_directories(dir);
+    std::filesystem::current_path(dir);
+    int before = failures;
+    test();
+    std::cout << (failures == before ? "[ OK ] " : "[FAIL] ") << name << "\n";
+}
+
+int main() {
+    auto stamp = std::chrono::steady_clock::now().time_since_epoch().count();
+    workDir = std::filesystem::temp_directory_path() / ("sem6_tests_" + std::to_string(stamp));
+    std::filesystem::create_directories(workDir);
+
+    run("TrajectoryLogger: перезагрузка сбрасывает статистику", testTrajectoryReloadResetsStatistics);
+    run("TrajectoryLogger: запросы по времени к неупорядоченному журналу", testTrajectoryUnorderedQueries);
+    run("TrajectoryLogger: повторное сохранение тем же писателем", testTrajectorySaveReuse);
+    run("AsyncFileWriter: политики fsync, кольцо и обычная запись", testAsyncFileWriterSyncPolicies);
+    run("SpatialGrid: ближайшие и шар, далекие и некорректные точки", testSpatialGridQueries);
+    run("IdSlotMap: удаление сдвигом через край таблицы", testIdSlotMapErase);
+    run("TargetManager: выборка по приоритету, замена, NaN", testPriorityView);
+    run("RadixSorter: совпадает с stable_sort, знаки нуля, inf и NaN", testRadixSorterMatchesStableSort);
+    run("TargetManager: снимки читателей при работающем писателе", testSnapshotReadersWhileWriting);
+    run("TargetManager: восстановление из журнала, битый снимок", testTargetJournalRecovery);
+    run("TargetManager: пул имен не растет при замене и удалении", testTargetNamePoolChurn);
+    run("MpscRing: порядок писателей и заполнение", testMpscRingOrderAndCapacity);
+    run("TelemetryLogger: несколько писателей, все записи в файлах", testTelemetryLoggerConcurrentWriters);
+    run("TelemetryLogger: сводка во время записи", testTelemetrySummaryWhileLogging);
+    run("TelemetryFile: заголовок, старый формат, поврежденные файлы, архив", testTelemetryFileFormats);
+    run("GorillaCodec: побитовое восстановление, -0.0 и нецелые микросекунды", testGorillaRoundTrip);
+    run("TelemetryIndex: каталог и переписанные файлы", testTelemetryCatalogStaleness);
+    run("TelemetryRollups: интервалы на границах файлов", testTelemetryRollups);
+    run("LiveTelemetryRing: емкость, второй писатель, сегмент упавшего писателя", testLiveTelemetryRing);
+    run("RouteSegmentIndex: ближайший участок совпадает с перебором", testRouteSegmentIndex);
+    run("WaypointManager: маршрут туда и обратно, срезанный угол", testWaypointOutAndBack);
+    run("RouteOptimizer: детерминизм по числу потоков, перестановка от узла 0", testRouteOptimizer);
+    run("DataValidator: маски пачек, примеры, отдельные значения", testDataValidator);
+
+    std::error_code ec;
+    std::filesystem::current_path(workDir.parent_path(), ec);
+    std::filesystem::remove_all(workDir, ec);
+    std::cout << (failures ? "Есть ошибки: " + std::to_string(failures) : std::string("Все проверки пройдены")) << "\n";
+    return failures ? 1 : 0;
+}
@@ -1,547 +1,1767 @@
-// Авиационный профиль: Моделирование вертикальной траектории
-// Версия 1.2 | Последнее обновление: 23.10.2023
-
-#include <iostream>
-#include <vector>
-#include <cmath>
-#include <fstream>
-#include <iomanip>
-#include <string>
-#include <algorithm>
-#include <memory>
-#include <cstdio>
-#include <stdio.h> 
-#include <stdlib.h> 
-#include <locale.h>
-#define M_PI 3.14159
-
-// ------------------------------------------------------------------
-// КОНСТАНТЫ ДЛЯ МОДЕЛИ ТУ-154
-// ------------------------------------------------------------------
-const double MASS_BASELINE = 43000.0;      // базовая масса, кг
-const double WING_SPAN_AREA = 127.3;        // площадь крыла, м²
-const double THRUST_TOTAL = 2*6800.0;     // суммарная тяга двигателей, Н
-const double THROTTLE_SETTING = 1.;         // положение РУД
-const double ALT_START = 300.0;        // начальная высота, м
-const double ALT_TARGET = 6000.0;       // целевая высота, м
-const double VEL_INITIAL_KPH = 310.0;        // начальная скорость, км/ч
-const double VEL_TARGET_KPH = 700.0;        // целевая скорость, км/ч
-const double G_CONST = 9.81;         // ускорение свободного падения
-const double R_GAS_AIR = 287.05;       // газовая постоянная воздуха
-
-// Преобразование скоростей в м/с
-const double VEL_INITIAL_MS = VEL_INITIAL_KPH / 3.6;
-const double VEL_TARGET_MS = VEL_TARGET_KPH / 3.6;
-
-// ------------------------------------------------------------------
-// КЛАСС ДЛЯ РАБОТЫ С CSV-ФАЙЛАМИ
-// ------------------------------------------------------------------
-class CSVExport {
-    std::ofstream outputStream;
-
-public:
-    explicit CSVExport(const std::string& fname) {
-        outputStream.open(fname);
-        if (!outputStream.is_open()) {
-            throw std::runtime_error("Не удалось открыть файл " + fname);
-        }
-    }
-
-    ~CSVExport() {
-        if (outputStream.is_open()) {
-            outputStream.close();
-        }
-    }
-
-    void writeHeaders(const std::vector<std::string>& headers) {
-        for (size_t idx = 0; idx < headers.size(); ++idx) {
-            outputStream << headers[idx];
-            if (idx != headers.size() - 1) outputStream << ',';
-        }
-        outputStream << '\n';
-    }
-
-    void addDataLine(const std::vector<double>& values) {
-        for (size_t idx = 0; idx < values.size(); ++idx) {
-            outputStream << std::setprecision(6) << values[idx];
-            if (idx != values.size() - 1) outputStream << ',';
-        }
-        outputStream << '\n';
-    }
-};
-
-// ------------------------------------------------------------------
-// ИНТЕРПОЛЯТОР ДАННЫХ СТАНДАРТНОЙ АТМОСФЕРЫ
-// ------------------------------------------------------------------
-class AtmosphereData {
-    std::vector<double> hVec;      // высоты, м
-    std::vector<double> tVec;      // температуры, К
-    std::vector<double> pVec;      // давления, Па
-    std::vector<double> rhoVec;    // плотности, кг/м³
-    std::vector<double> aVec;      // скорости звука, м/с
-
-public:
-    AtmosphereData() {
-        loadReferenceData();
-    }
-
-private:
-    void loadReferenceData() {
-        // Табличные данные МСА
-        hVec = {0, 500, 1000, 1500, 2000, 2500, 3000, 3500, 4000, 4500, 5000,  5500,   6000};
-        tVec = {288.15, 284.90, 281.65, 278.40, 275.15, 271.90, 268.65, 265.40, 262.15, 258.90, 255.65, 252.40, 249.15  };
-        pVec = {101325.0, 95463.0, 89976.0, 84808.0, 79916.0, 75260.0, 70801.0, 66604.0, 62634.0, 58860.0, 55252.0, 51881.0, 48720.0};
-        rhoVec = {1.2250, 1.1673, 1.1117, 1.0581, 1.0066, 0.9570, 0.9093, 0.8635, 0.8196, 0.7775, 0.7369, 0.6979, 0.6605};
-        aVec = {340.29, 338.37, 336.44, 334.50, 332.54, 330.57, 328.58, 326.58, 324.56, 322.52, 320.47, 318.40, 316.31};
-    }
-
-    double linearInterp(double x, const std::vector<double>& xs,
-        const std::vector<double>& ys) const {
-        if (x <= xs[0]) return ys[0];
-        if (x >= xs.back()) return ys.back();
-
-        for (size_t i = 0; i < xs.size() - 1; ++i)
-            {
-                    if (x >= xs[i] && x <= xs[i + 1]) {
-                        double frac = (x - xs[i]) / (xs[i + 1] - xs[i]);
-                        return ys[i] + frac * (ys[i + 1] - ys[i]);
-                    }
-            }
-        return ys.back();
-    }
-
-public:
-    double temperature(double altitude) const {
-        return linearInterp(altitude, hVec, tVec);
-    }
-
-    double pressure(double altitude) const {
-        return linearInterp(altitude, hVec, pVec);
-    }
-
-    double density(double altitude) const {
-        return linearInterp(altitude, hVec, rhoVec);
-    }
-
-    double soundSpeed(double altitude) const {
-        return linearInterp(altitude, hVec, aVec);
-    }
-
-    double machNumber(double velocity, double altitude) const {
-        return velocity / soundSpeed(altitude);
-    }
-};
-
-// ------------------------------------------------------------------
-// СТРУКТУРА ДАННЫХ ТОЧКИ ТРАЕКТОРИИ
-// ------------------------------------------------------------------
-struct FlightState {
-    double t;           // время, с
-    double x;           // горизонтальная координата, м
-    double h;           // высота, м
-    double V;           // полная скорость, м/с
-    double Vh;          // горизонтальная составляющая скорости, м/с
-    double Vv;          // вертикальная составляющая скорости, м/с
-    double theta;       // угол траектории, рад
-    double alpha;       // угол атаки, рад
-    double fuelUsed;    // израсходованное топливо, кг
-    double massCurr;    // текущая масса, кг
-    double accel;       // ускорение, м/с²
-    double mach;        // число Маха
-
-    FlightState(double time = 0, double posX = 0, double altitude = 0,
-        double speed = 0, double speedH = 0, double speedV = 0,
-        double pathAngle = 0, double aoa = 0, double fuel = 0,
-        double mass = MASS_BASELINE, double acceleration = 0,
-        double machNum = 0)
-        : t(time), x(posX), h(altitude), V(speed), Vh(speedH), Vv(speedV),
-        theta(pathAngle), alpha(aoa), fuelUsed(fuel), massCurr(mass),
-        accel(acceleration), mach(machNum) {}
-
-    void display() const {
-        std::cout << std::fixed << std::setprecision(1);
-        std::cout << "Время: " << t << "с | Высота: " << h << "м | ";
-        std::cout << "Скорость: " << V * 3.6 << "км/ч | ";
-        std::cout << "Вертикальная скорость: " << Vv << "м/с | ";
-        std::cout << "Угол: " << theta * 180 / M_PI << "° | ";
-        std::cout << "Масса: " << massCurr << "кг\n";
-    }
-};
-
-// ------------------------------------------------------------------
-// КЛАСС ДЛЯ ХРАНЕНИЯ ТРАЕКТОРИИ ПОЛЕТА
-// ------------------------------------------------------------------
-class FlightPath {
-    std::vector<FlightState> pathPoints;
-
-public:
-    FlightPath() = default;
-
-    void appendPoint(const FlightState& point) {
-        pathPoints.push_back(point);
-    }
-
-    const std::vector<FlightState>& getAllPoints() const {
-        return pathPoints;
-    }
-
-    double totalDuration() const {
-        return pathPoints.empty() ? 0.0 : pathPoints.back().t;
-    }
-
-    double totalFuelConsumed() const {
-        return pathPoints.empty() ? 0.0 : pathPoints.back().fuelUsed;
-    }
-
-    void exportToCSV(const std::string& filename) {
-        CSVExport csvFile(filename);
-
-        csvFile.writeHeaders({
-            "time_s", "altitude_m", "velocity_ms", "velocity_kmh",
-            "vertical_velocity_ms", "theta_deg", "alpha_deg",
-            "fuel_kg", "mass_kg", "acceleration_ms2", "mach_number"
-            });
-
-        for (const auto& pt : pathPoints) {
-            csvFile.addDataLine({
-                pt.t, pt.h, pt.V, pt.V * 3.6,
-                pt.Vv, pt.theta * 180 / M_PI, pt.alpha * 180 / M_PI,
-                pt.fuelUsed, pt.massCurr, pt.accel, pt.mach
-                });
-        }
-
-        std::cout << "Экспорт завершен. Файл: " << filename << '\n';
-    }
-
-    void visualize() const {
-        // Создаем временный файл с данными для построения
-        const std::string dataFile = "temp_plot_data.dat";
-        std::ofstream dataStream(dataFile);
-
-        if (!dataStream.is_open()) {
-            std::cerr << "Не удалось создать временный файл данных\n";
-            return;
-        }
-
-        // Записываем данные в формате: время высота скорость_кмч
-        for (const auto& pt : pathPoints) {
-            dataStream << std::fixed << std::setprecision(2)
-                << pt.t << " " << pt.h << " " << pt.V * 3.6 << "\n";
-        }
-        dataStream.close();
-
-#ifdef _WIN32
-        // Для Windows - создаем файл скрипта Gnuplot и предлагаем пользователю запустить его
-        createWindowsGnuplotScript(dataFile);
-        std::cout << "\nДля визуализации:\n";
-        std::cout << "1. Установите Gnuplot (http://www.gnuplot.info)\n";
-        std::cout << "2. Запустите файл plot_script.plt\n";
-        std::cout << "Или откройте CSV файл в Excel/Google Sheets\n";
-#else
-        // Для Linux/Mac используем popen
-        FILE* gnuplotPipe = popen("gnuplot -persistent", "w");
-        if (!gnuplotPipe) {
-            std::cerr << "Ошибка инициализации Gnuplot\n";
-            std::cout << "Данные для построения сохранены в " << dataFile << "\n";
-            return;
-        }
-
-        fprintf(gnuplotPipe, "set terminal wxt size 1200,800 font 'Arial,12'\n");
-        fprintf(gnuplotPipe, "set multiplot layout 2,2 title 'Динамика полета ТУ-154'\n");
-
-        // График высоты
-        fprintf(gnuplotPipe, "set title 'Изменение высоты'\n");
-        fprintf(gnuplotPipe, "set xlabel 'Время, с'\n");
-        fprintf(gnuplotPipe, "set ylabel 'Высота, м'\n");
-        fprintf(gnuplotPipe, "set grid\n");
-        fprintf(gnuplotPipe, "plot '%s' using 1:2 with lines lw 2 lc 'blue' title 'Высота'\n",
-            dataFile.c_str());
-
-        // График скорости
-        fprintf(gnuplotPipe, "set title 'Изменение скорости'\n");
-        fprintf(gnuplotPipe, "set xlabel 'Время, с'\n");
-        fprintf(gnuplotPipe, "set ylabel 'Скорость, км/ч'\n");
-        fprintf(gnuplotPipe, "set grid\n");
-        fprintf(gnuplotPipe, "plot '%s' using 1:3 with lines lw 2 lc 'red' title 'Скорость'\n",
-            dataFile.c_str());
-
-        fprintf(gnuplotPipe, "unset multiplot\n");
-        fflush(gnuplotPipe);
-
-        std::cout << "Для продолжения закройте окно Gnuplot...\n";
-        std::cin.get();
-
-        pclose(gnuplotPipe);
-#endif
-
-        // Удаляем временный файл
-        std::remove(dataFile.c_str());
-    }
-
-#ifdef _WIN32
-    void createWindowsGnuplotScript(const std::string& dataFile) const {
-        std::ofstream script("plot_script.plt");
-        if (!script.is_open()) return;
-
-        script << "# Скрипт Gnuplot для визуализации траектории\n";
-        script << "set terminal png size 1200,800 enhanced font 'Arial,12'\n";
-        script << "set output 'flight_trajectory.png'\n";
-        script << "set multiplot layout 2,2 title 'Динамика полета ТУ-154'\n\n";
-
-        script << "# График высоты\n";
-        script << "set title 'Изменение высоты'\n";
-        script << "set xlabel 'Время, с'\n";
-        script << "set ylabel 'Высота, м'\n";
-        script << "set grid\n";
-        script << "plot '" << dataFile << "' using 1:2 with lines lw 2 lc 'blue' title 'Высота'\n\n";
-
-        script << "# График скорости\n";
-        script << "set title 'Изменение скорости'\n";
-        script << "set xlabel 'Время, с'\n";
-        script << "set ylabel 'Скорость, км/ч'\n";
-        script << "set grid\n";
-        script << "plot '" << dataFile << "' using 1:3 with lines lw 2 lc 'red' title 'Скорость'\n\n";
-
-        script << "unset multiplot\n";
-        script << "print 'График сохранен в файл flight_trajectory.png'\n";
-        script << "pause -1\n";
-
-        script.close();
-    }
-#endif
-};
-
-// ------------------------------------------------------------------
-// МОДЕЛЬ ЛЕТАТЕЛЬНОГО АППАРАТА
-// ------------------------------------------------------------------
-class AircraftModel {
-    AtmosphereData atmosphere;
-    double wingArea;
-    double massInitial;
-
-public:
-    double massCurrent;
-    double thrust;
-    double fuelBurnRate;
-    double dragCoeffZero;
-    double inducedDragCoeff;
-    double maxLiftCoeff;
-
-    AircraftModel(double mass = MASS_BASELINE, double area = WING_SPAN_AREA)
-        : wingArea(area), massInitial(mass), massCurrent(mass) {
-
-        thrust = THRUST_TOTAL * THROTTLE_SETTING;
-        fuelBurnRate = 2.5;                // кг/с
-        dragCoeffZero = 0.02;
-        inducedDragCoeff = 0.05;
-        maxLiftCoeff = 1.2;
-    }
-
-    double computeLiftCoeff(double aoa) const {
-        const double LIFT_SLOPE = 5.0;
-        return std::min(LIFT_SLOPE * aoa, maxLiftCoeff);
-    }
-
-    double computeDragCoeff(double liftCoeff) const {
-        return dragCoeffZero + inducedDragCoeff * liftCoeff * liftCoeff;
-    }
-
-    double calculateLift(double velocity, double altitude, double aoa) const {
-        double airDensity = atmosphere.density(altitude);
-        double dynamicPress = 0.5 * airDensity * velocity * velocity;
-        double cl = computeLiftCoeff(aoa);
-        return cl * wingArea * dynamicPress;
-    }
-
-    double calculateDrag(double velocity, double altitude, double aoa) const {
-        double airDensity = atmosphere.density(altitude);
-        double dynamicPress = 0.5 * airDensity * velocity * velocity;
-        double cl = computeLiftCoeff(aoa);
-        double cd = computeDragCoeff(cl);
-        return cd * wingArea * dynamicPress;
-    }
-
-    FlightState propagateState(const FlightState& current,
-        double timeStep,
-        double commandedAOA) {
-        FlightState next = current;
-
-        // Ограничение угла атаки
-        commandedAOA = std::max(-0.1, std::min(0.2, commandedAOA));
-
-        // Расчет аэродинамических сил
-        double liftForce = calculateLift(current.V, current.h, commandedAOA);
-        double dragForce = calculateDrag(current.V, current.h, commandedAOA);
-
-        // Уравнения движения
-        double forceX = thrust - dragForce - massCurrent * G_CONST * sin(current.theta);
-        double forceY = liftForce - massCurrent * G_CONST * cos(current.theta);
-
-        double accelX = forceX / massCurrent;
-        double accelY = forceY / massCurrent;
-
-        // Интегрирование скорости
-        next.V = current.V + accelX * timeStep;
-        next.V = std::max(100.0, next.V);  // минимальная скорость
-
-        if (next.V > 0) {
-            next.theta = atan2(accelY, accelX + G_CONST * sin(current.theta));
-        }
-
-        next.theta = std::max(-0.3, std::min(0.3, next.theta));
-        next.Vh = next.V * cos(next.theta);
-        next.Vv = next.V * sin(next.theta);
-
-        // Интегрирование координат
-        next.x = current.x + next.Vh * timeStep;
-        next.h = current.h + next.Vv * timeStep;
-
-        // Защита от отрицательной высоты
-        if (next.h < 0) {
-            next.h = 10.0;
-            next.Vv = std::max(0.0, next.Vv);
-        }
-
-        // Обновление параметров
-        next.alpha = commandedAOA;
-        next.mach = atmosphere.machNumber(next.V, next.h);
-        next.accel = accelX;
-
-        double deltaFuel = fuelBurnRate * timeStep;
-        next.fuelUsed = current.fuelUsed + deltaFuel;
-        next.massCurr = current.massCurr - deltaFuel;
-
-        // Коррекция тяги (упрощенная модель)
-        thrust = THRUST_TOTAL * THROTTLE_SETTING * (next.massCurr / massInitial);
-
-        next.t = current.t + timeStep;
-
-        return next;
-    }
-
-    double initialMass() const { return massInitial; }
-};
-
-// ------------------------------------------------------------------
-// АЛГОРИТМ ОПТИМИЗАЦИИ ТРАЕКТОРИИ
-// ------------------------------------------------------------------
-class TrajectoryOptimizer {
-public:
-    TrajectoryOptimizer() = default;
-
-    FlightPath computeOptimalPath(AircraftModel& aircraft,
-        double maxTime = 600.0) {
-        FlightPath resultPath;
-        const double TIME_STEP = 1.0;
-
-        // Начальные условия
-        FlightState initialState;
-        initialState.t = 0;
-        initialState.x = 0;
-        initialState.h = ALT_START;
-        initialState.V = VEL_INITIAL_MS;
-        initialState.Vh = VEL_INITIAL_MS;
-        initialState.Vv = 5.0;
-        initialState.theta = 0.05;
-        initialState.alpha = 0.03;
-        initialState.fuelUsed = 0;
-        initialState.massCurr = aircraft.initialMass();
-        initialState.accel = 0;
-
-        AtmosphereData envCalc;
-        initialState.mach = envCalc.machNumber(initialState.V, initialState.h);
-
-        FlightState currentState = initialState;
-        resultPath.appendPoint(currentState);
-
-        std::cout << "\n=== ПАРАМЕТРЫ МОДЕЛИРОВАНИЯ ===\n";
-        std::cout << "Целевая высота: " << ALT_TARGET << " м\n";
-        std::cout << "Целевая скорость: " << VEL_TARGET_KPH << " км/ч\n";
-        std::cout << "Максимальное время: " << maxTime << " с\n\n";
-
-        int iteration = 0;
-        bool targetAchieved = false;
-
-        while (currentState.t < maxTime && !targetAchieved) {
-            iteration++;
-
-            // Простой закон управления углом атаки
-            double heightFraction = currentState.h / ALT_TARGET;
-            double aoaCommand;
-
-            if (heightFraction < 0.3) {
-                aoaCommand = 0.06;          // активный набор высоты
-            }
-            else if (heightFraction < 0.7) {
-                aoaCommand = 0.04;          // переходный режим
-            }
-            else {
-                aoaCommand = 0.02;          // вывод на заданную высоту
-            }
-
-            // Коррекция для набора скорости
-            if (currentState.V < VEL_TARGET_MS * 0.9) {
-                aoaCommand -= 0.01;
-            }
-
-            currentState = aircraft.propagateState(currentState,
-                TIME_STEP,
-                aoaCommand);
-            resultPath.appendPoint(currentState);
-
-            // Периодический вывод информации
-            if (iteration % 30 == 0) {
-                std::cout << "Шаг " << iteration << " | ";
-                std::cout << "Время: " << currentState.t << "с | ";
-                std::cout << "Высота: " << currentState.h << "м | ";
-                std::cout << "Скорость: " << currentState.V * 3.6 << "км/ч\n";
-            }
-
-            // Проверка достижения цели
-            if (currentState.h >= ALT_TARGET) {
-                targetAchieved = true;
-                std::cout << "\n>>> ЦЕЛЕВАЯ ВЫСОТА ДОСТИГНУТА! <<<\n";
-            }
-
-            // Проверка на нефизичные значения
-            if (currentState.h > 20000 || currentState.V > 1000) {
-                std::cout << "\n!!! Прерывание: выход за допустимые пределы\n";
-                break;
-            }
-        }
-
-        // Итоговый отчет
-        std::cout << "\n=== РЕЗУЛЬТАТЫ МОДЕЛИРОВАНИЯ ===\n";
-        std::cout << "Финальная высота: " << currentState.h << " м ("
-            << (currentState.h / ALT_TARGET * 100) << "% от цели)\n";
-        std::cout << "Финальная скорость: " << currentState.V * 3.6 << " км/ч\n";
-        std::cout << "Общее время: " << currentState.t << " с\n";
-        std::cout << "Расход топлива: " << currentState.fuelUsed << " кг\n";
-        std::cout << "Число Маха: " << currentState.mach << "\n";
-
-        return resultPath;
-    }
-};
-
-// ------------------------------------------------------------------
-// ОСНОВНАЯ ФУНКЦИЯ
-// ------------------------------------------------------------------
-int main() {
-    setlocale(LC_ALL, "ru");
-    try {
-        AircraftModel tu134Model;
-        TrajectoryOptimizer optimizer;
-
-        FlightPath trajectory = optimizer.computeOptimalPath(tu134Model, 300.0);
-
-        trajectory.exportToCSV("flight_profile_tu154.csv");
-        trajectory.visualize();
-
-    }
-    catch (const std::exception& err) {
-        std::cerr << "КРИТИЧЕСКАЯ ОШИБКА: " << err.what() << '\n';
-        return EXIT_FAILURE;
-    }
-
-    return EXIT_SUCCESS;
-}
\ No newline at end of file
+// Авиационный профиль: Моделирование вертикальной траектории
+// Версия 1.2 | Последнее обновление: 23.10.2023
+
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <algorithm>
+#include <memory>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <cctype>
+#include <filesystem>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <deque>
+#include <map>
+#include <atomic>
+#include <cerrno>
+#include <stdio.h> 
+#include <stdlib.h> 
+#include <locale.h>
+#include "realtime_pacer.h"
+#ifndef _WIN32
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+#define M_PI 3.14159
+
+// ------------------------------------------------------------------
+// КОНСТАНТЫ ДЛЯ МОДЕЛИ ТУ-154
+// ------------------------------------------------------------------
+const double MASS_BASELINE = 43000.0;      // базовая масса, кг
+const double WING_SPAN_AREA = 127.3;        // площадь крыла, м²
+const double THRUST_TOTAL = 2*6800.0;     // суммарная тяга двигателей, Н
+const double THROTTLE_SETTING = 1.;         // положение РУД
+const double ALT_START = 300.0;        // начальная высота, м
+const double ALT_TARGET = 6000.0;       // целевая высота, м
+const double VEL_INITIAL_KPH = 310.0;        // начальная скорость, км/ч
+const double VEL_TARGET_KPH = 700.0;        // целевая скорость, км/ч
+const double G_CONST = 9.81;         // ускорение свободного падения
+const double R_GAS_AIR = 287.05;       // газовая постоянная воздуха
+
+// Преобразование скоростей в м/с
+const double VEL_INITIAL_MS = VEL_INITIAL_KPH / 3.6;
+const double VEL_TARGET_MS = VEL_TARGET_KPH / 3.6;
+
+// ------------------------------------------------------------------
+// КЛАСС ДЛЯ РАБОТЫ С CSV-ФАЙЛАМИ
+// ------------------------------------------------------------------
+class CSVExport {
+    std::ofstream outputStream;
+
+public:
+    explicit CSVExport(const std::string& fname) {
+        outputStream.open(fname);
+        if (!outputStream.is_open()) {
+            throw std::runtime_error("Не удалось открыть файл " + fname);
+        }
+    }
+
+    ~CSVExport() {
+        if (outputStream.is_open()) {
+            outputStream.close();
+        }
+    }
+
+    void writeHeaders(const std::vector<std::string>& headers) {
+        for (size_t idx = 0; idx < headers.size(); ++idx) {
+            outputStream << headers[idx];
+            if (idx != headers.size() - 1) outputStream << ',';
+        }
+        outputStream << '\n';
+    }
+
+    void addDataLine(const std::vector<double>& values) {
+        for (size_t idx = 0; idx < values.size(); ++idx) {
+            outputStream << std::setprecision(6) << values[idx];
+            if (idx != values.size() - 1) outputStream << ',';
+        }
+        outputStream << '\n';
+    }
+};
+
+// ------------------------------------------------------------------
+// ХЕШИРОВАНИЕ ВХОДНЫХ ДАННЫХ РАСЧЕТА (FNV-1a, 64 бит)
+// ------------------------------------------------------------------
+class InputHasher {
+    uint64_t state = 1469598103934665603ULL;
+
+public:
+    void addBytes(const void* data, size_t size) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            state ^= bytes[i];
+            state *= 1099511628211ULL;
+        }
+    }
+
+    void add(double value) {
+        if (value == 0.0) value = 0.0;   // -0.0 и 0.0 дают один ключ
+        addBytes(&value, sizeof(value));
+    }
+
+    void add(uint64_t value) {
+        addBytes(&value, sizeof(value));
+    }
+
+    void add(const std::vector<double>& values) {
+        add(static_cast<uint64_t>(values.size()));
+        for (double v : values) add(v);
+    }
+
+    uint64_t value() const { return state; }
+
+    std::string hex() const {
+        char buf[17];
+        std::snprintf(buf, sizeof(buf), "%016llx",
+            static_cast<unsigned long long>(state));
+        return buf;
+    }
+};
+
+// ------------------------------------------------------------------
+// ИНТЕРПОЛЯТОР ДАННЫХ СТАНДАРТНОЙ АТМОСФЕРЫ
+// ------------------------------------------------------------------
+class AtmosphereData {
+    std::vector<double> hVec;      // высоты, м
+    std::vector<double> tVec;      // температуры, К
+    std::vector<double> pVec;      // давления, Па
+    std::vector<double> rhoVec;    // плотности, кг/м³
+    std::vector<double> aVec;      // скорости звука, м/с
+
+public:
+    AtmosphereData() {
+        loadReferenceData();
+    }
+
+    // Таблицы МСА не меняются: один экземпляр на процесс
+    static const AtmosphereData& standard() {
+        static const AtmosphereData data;
+        return data;
+    }
+
+private:
+    void loadReferenceData() {
+        // Табличные данные МСА
+        hVec = {0, 500, 1000, 1500, 2000, 2500, 3000, 3500, 4000, 4500, 5000,  5500,   6000};
+        tVec = {288.15, 284.90, 281.65, 278.40, 275.15, 271.90, 268.65, 265.40, 262.15, 258.90, 255.65, 252.40, 249.15  };
+        pVec = {101325.0, 95463.0, 89976.0, 84808.0, 79916.0, 75260.0, 70801.0, 66604.0, 62634.0, 58860.0, 55252.0, 51881.0, 48720.0};
+        rhoVec = {1.2250, 1.1673, 1.1117, 1.0581, 1.0066, 0.9570, 0.9093, 0.8635, 0.8196, 0.7775, 0.7369, 0.6979, 0.6605};
+        aVec = {340.29, 338.37, 336.44, 334.50, 332.54, 330.57, 328.58, 326.58, 324.56, 322.52, 320.47, 318.40, 316.31};
+    }
+
+    double linearInterp(double x, const std::vector<double>& xs,
+        const std::vector<double>& ys) const {
+        if (x <= xs[0]) return ys[0];
+        if (x >= xs.back()) return ys.back();
+
+        for (size_t i = 0; i < xs.size() - 1; ++i)
+            {
+                    if (x >= xs[i] && x <= xs[i + 1]) {
+                        double frac = (x - xs[i]) / (xs[i + 1] - xs[i]);
+                        return ys[i] + frac * (ys[i + 1] - ys[i]);
+                    }
+            }
+        return ys.back();
+    }
+
+public:
+    double temperature(double altitude) const {
+        return linearInterp(altitude, hVec, tVec);
+    }
+
+    double pressure(double altitude) const {
+        return linearInterp(altitude, hVec, pVec);
+    }
+
+    double density(double altitude) const {
+        return linearInterp(altitude, hVec, rhoVec);
+    }
+
+    double soundSpeed(double altitude) const {
+        return linearInterp(altitude, hVec, aVec);
+    }
+
+    double machNumber(double velocity, double altitude) const {
+        return velocity / soundSpeed(altitude);
+    }
+
+    void hashInto(InputHasher& hasher) const {
+        hasher.add(hVec);
+        hasher.add(tVec);
+        hasher.add(pVec);
+        hasher.add(rhoVec);
+        hasher.add(aVec);
+    }
+};
+
+// ------------------------------------------------------------------
+// СЕТОЧНОЕ ПОЛЕ ВЕТРА И ОТКЛОНЕНИЯ ТЕМПЕРАТУРЫ (x, высота, время)
+// ------------------------------------------------------------------
+struct WindSample {
+    double windX = 0;      // горизонтальный ветер вдоль оси x (попутный > 0), м/с
+    double windV = 0;      // вертикальный поток, м/с
+    double tempDev = 0;    // отклонение температуры от МСА, К
+};
+
+class WindField {
+    // Узел хранится во float: блок 4x4x4 занимает 768 байт
+    struct Node {
+        float windX, windV, tempDev;
+    };
+
+    static const int BLOCK = 4;
+
+    double x0, dx, h0, dh, t0, dt;
+    int nx, nh, nt;
+    int blocksX, blocksH;
+    std::vector<Node> nodes;          // блоки BLOCK^3, внутри блока x меняется быстрее
+    uint64_t fingerprint = 0;         // пересчитывается при каждом изменении узлов
+
+    size_t nodeIndex(int i, int j, int k) const {
+        size_t block = (static_cast<size_t>(k / BLOCK) * blocksH + j / BLOCK) * blocksX + i / BLOCK;
+        int inner = ((k % BLOCK) * BLOCK + j % BLOCK) * BLOCK + i % BLOCK;
+        return block * BLOCK * BLOCK * BLOCK + inner;
+    }
+
+    void storeNode(int i, int j, int k, const WindSample& value) {
+        nodes[nodeIndex(i, j, k)] = { static_cast<float>(value.windX),
+            static_cast<float>(value.windV), static_cast<float>(value.tempDev) };
+    }
+
+    void refreshFingerprint() {
+        InputHasher own;
+        double axes[6] = { x0, dx, h0, dh, t0, dt };
+        for (double a : axes) own.add(a);
+        own.add(static_cast<uint64_t>(nx));
+        own.add(static_cast<uint64_t>(nh));
+        own.add(static_cast<uint64_t>(nt));
+        own.addBytes(nodes.data(), nodes.size() * sizeof(Node));
+        fingerprint = own.value();
+    }
+
+    // Индекс ячейки и доля внутри нее; за границами сетки - значения на краю,
+    // NaN - как левый край (до приведения к int, иначе UB)
+    static void locate(double v, double origin, double step, int count, int& cell, double& frac) {
+        double pos = (v - origin) / step;
+        if (!(pos > 0)) { cell = 0; frac = 0; return; }
+        if (pos >= count - 1) { cell = count - 2; frac = 1; return; }
+        cell = static_cast<int>(pos);
+        frac = pos - cell;
+    }
+
+public:
+    // Курсор одной траектории: помнит последнюю ячейку и ее 8 узлов
+    struct Cursor {
+        int i = -1, j = -1, k = -1;
+        Node corners[8];
+    };
+
+    WindField(double xStart, double xStep, int xCount,
+        double hStart, double hStep, int hCount,
+        double tStart, double tStep, int tCount)
+        : x0(xStart), dx(xStep), h0(hStart), dh(hStep), t0(tStart), dt(tStep),
+        nx(xCount), nh(hCount), nt(tCount) {
+        if (nx < 2 || nh < 2 || nt < 2 || dx <= 0 || dh <= 0 || dt <= 0) {
+            throw std::invalid_argument("Сетка ветра: нужно не менее 2 узлов и шаг > 0 по каждой оси");
+        }
+        blocksX = (nx + BLOCK - 1) / BLOCK;
+        blocksH = (nh + BLOCK - 1) / BLOCK;
+        int blocksT = (nt + BLOCK - 1) / BLOCK;
+        nodes.assign(static_cast<size_t>(blocksX) * blocksH * blocksT * BLOCK * BLOCK * BLOCK,
+            Node{ 0, 0, 0 });
+        refreshFingerprint();
+    }
+
+    int sizeX() const { return nx; }
+    int sizeH() const { return nh; }
+    int sizeT() const { return nt; }
+
+    // Отпечаток пересчитывается по всей сетке: для массовой записи - fill
+    void setNode(int i, int j, int k, const WindSample& value) {
+        storeNode(i, j, k, value);
+        refreshFingerprint();
+    }
+
+    // Заполнение по функции f(x, h, t) -> WindSample
+    template <typename F>
+    void fill(F f) {
+        for (int k = 0; k < nt; ++k)
+            for (int j = 0; j < nh; ++j)
+                for (int i = 0; i < nx; ++i)
+                    storeNode(i, j, k, f(x0 + i * dx, h0 + j * dh, t0 + k * dt));
+        refreshFingerprint();
+    }
+
+    WindSample sample(double x, double h, double t, Cursor& cursor) const {
+        int i, j, k;
+        double fx, fh, ft;
+        locate(x, x0, dx, nx, i, fx);
+        locate(h, h0, dh, nh, j, fh);
+        locate(t, t0, dt, nt, k, ft);
+
+        if (i != cursor.i || j != cursor.j || k != cursor.k) {
+            for (int c = 0; c < 8; ++c) {
+                cursor.corners[c] = nodes[nodeIndex(i + (c & 1), j + ((c >> 1) & 1), k + (c >> 2))];
+            }
+            cursor.i = i;
+            cursor.j = j;
+            cursor.k = k;
+        }
+
+        const Node* c = cursor.corners;
+        auto lerp = [](double a, double b, double f) { return a + f * (b - a); };
+        auto blend = [&](float Node::* field) {
+            double x00 = lerp(c[0].*field, c[1].*field, fx);
+            double x10 = lerp(c[2].*field, c[3].*field, fx);
+            double x01 = lerp(c[4].*field, c[5].*field, fx);
+            double x11 = lerp(c[6].*field, c[7].*field, fx);
+            return lerp(lerp(x00, x10, fh), lerp(x01, x11, fh), ft);
+        };
+
+        WindSample result;
+        result.windX = blend(&Node::windX);
+        result.windV = blend(&Node::windV);
+        result.tempDev = blend(&Node::tempDev);
+        return result;
+    }
+
+    // Только чтение: безопасно из нескольких потоков
+    void hashInto(InputHasher& hasher) const {
+        hasher.add(fingerprint);
+    }
+};
+
+// ------------------------------------------------------------------
+// СТРУКТУРА ДАННЫХ ТОЧКИ ТРАЕКТОРИИ
+// ------------------------------------------------------------------
+struct FlightState {
+    double t;           // время, с
+    double x;           // горизонтальная координата, м
+    double h;           // высота, м
+    double V;           // полная скорость, м/с
+    double Vh;          // горизонтальная составляющая скорости, м/с
+    double Vv;          // вертикальная составляющая скорости, м/с
+    double theta;       // угол траектории, рад
+    double alpha;       // угол атаки, рад
+    double fuelUsed;    // израсходованное топливо, кг
+    double massCurr;    // текущая масса, кг
+    double accel;       // ускорение, м/с²
+    double mach;        // число Маха
+
+    FlightState(double time = 0, double posX = 0, double altitude = 0,
+        double speed = 0, double speedH = 0, double speedV = 0,
+        double pathAngle = 0, double aoa = 0, double fuel = 0,
+        double mass = MASS_BASELINE, double acceleration = 0,
+        double machNum = 0)
+        : t(time), x(posX), h(altitude), V(speed), Vh(speedH), Vv(speedV),
+        theta(pathAngle), alpha(aoa), fuelUsed(fuel), massCurr(mass),
+        accel(acceleration), mach(machNum) {}
+
+    void display() const {
+        std::cout << std::fixed << std::setprecision(1);
+        std::cout << "Время: " << t << "с | Высота: " << h << "м | ";
+        std::cout << "Скорость: " << V * 3.6 << "км/ч | ";
+        std::cout << "Вертикальная скорость: " << Vv << "м/с | ";
+        std::cout << "Угол: " << theta * 180 / M_PI << "° | ";
+        std::cout << "Масса: " << massCurr << "кг\n";
+    }
+};
+
+// ------------------------------------------------------------------
+// КЛАСС ДЛЯ ХРАНЕНИЯ ТРАЕКТОРИИ ПОЛЕТА
+// ------------------------------------------------------------------
+class FlightPath {
+    std::vector<FlightState> pathPoints;
+
+public:
+    FlightPath() = default;
+
+    void appendPoint(const FlightState& point) {
+        pathPoints.push_back(point);
+    }
+
+    const std::vector<FlightState>& getAllPoints() const {
+        return pathPoints;
+    }
+
+    // Оставить только первые count точек (общий префикс при досчете)
+    void truncate(size_t count) {
+        if (count < pathPoints.size()) pathPoints.resize(count);
+    }
+
+    double totalDuration() const {
+        return pathPoints.empty() ? 0.0 : pathPoints.back().t;
+    }
+
+    double totalFuelConsumed() const {
+        return pathPoints.empty() ? 0.0 : pathPoints.back().fuelUsed;
+    }
+
+    void exportToCSV(const std::string& filename) {
+        CSVExport csvFile(filename);
+
+        csvFile.writeHeaders({
+            "time_s", "altitude_m", "velocity_ms", "velocity_kmh",
+            "vertical_velocity_ms", "theta_deg", "alpha_deg",
+            "fuel_kg", "mass_kg", "acceleration_ms2", "mach_number"
+            });
+
+        for (const auto& pt : pathPoints) {
+            csvFile.addDataLine({
+                pt.t, pt.h, pt.V, pt.V * 3.6,
+                pt.Vv, pt.theta * 180 / M_PI, pt.alpha * 180 / M_PI,
+                pt.fuelUsed, pt.massCurr, pt.accel, pt.mach
+                });
+        }
+
+        std::cout << "Экспорт завершен. Файл: " << filename << '\n';
+    }
+
+    void visualize() const {
+        // Создаем временный файл с данными для построения
+        const std::string dataFile = "temp_plot_data.dat";
+        std::ofstream dataStream(dataFile);
+
+        if (!dataStream.is_open()) {
+            std::cerr << "Не удалось создать временный файл данных\n";
+            return;
+        }
+
+        // Записываем данные в формате: время высота скорость_кмч
+        for (const auto& pt : pathPoints) {
+            dataStream << std::fixed << std::setprecision(2)
+                << pt.t << " " << pt.h << " " << pt.V * 3.6 << "\n";
+        }
+        dataStream.close();
+
+#ifdef _WIN32
+        // Для Windows - создаем файл скрипта Gnuplot и предлагаем пользователю запустить его
+        createWindowsGnuplotScript(dataFile);
+        std::cout << "\nДля визуализации:\n";
+        std::cout << "1. Установите Gnuplot (http://www.gnuplot.info)\n";
+        std::cout << "2. Запустите файл plot_script.plt\n";
+        std::cout << "Или откройте CSV файл в Excel/Google Sheets\n";
+#else
+        // Для Linux/Mac используем popen
+        FILE* gnuplotPipe = popen("gnuplot -persistent", "w");
+        if (!gnuplotPipe) {
+            std::cerr << "Ошибка инициализации Gnuplot\n";
+            std::cout << "Данные для построения сохранены в " << dataFile << "\n";
+            return;
+        }
+
+        fprintf(gnuplotPipe, "set terminal wxt size 1200,800 font 'Arial,12'\n");
+        fprintf(gnuplotPipe, "set multiplot layout 2,2 title 'Динамика полета ТУ-154'\n");
+
+        // График высоты
+        fprintf(gnuplotPipe, "set title 'Изменение высоты'\n");
+        fprintf(gnuplotPipe, "set xlabel 'Время, с'\n");
+        fprintf(gnuplotPipe, "set ylabel 'Высота, м'\n");
+        fprintf(gnuplotPipe, "set grid\n");
+        fprintf(gnuplotPipe, "plot '%s' using 1:2 with lines lw 2 lc 'blue' title 'Высота'\n",
+            dataFile.c_str());
+
+        // График скорости
+        fprintf(gnuplotPipe, "set title 'Изменение скорости'\n");
+        fprintf(gnuplotPipe, "set xlabel 'Время, с'\n");
+        fprintf(gnuplotPipe, "set ylabel 'Скорость, км/ч'\n");
+        fprintf(gnuplotPipe, "set grid\n");
+        fprintf(gnuplotPipe, "plot '%s' using 1:3 with lines lw 2 lc 'red' title 'Скорость'\n",
+            dataFile.c_str());
+
+        fprintf(gnuplotPipe, "unset multiplot\n");
+        fflush(gnuplotPipe);
+
+        std::cout << "Для продолжения закройте окно Gnuplot...\n";
+        std::cin.get();
+
+        pclose(gnuplotPipe);
+#endif
+
+        // Удаляем временный файл
+        std::remove(dataFile.c_str());
+    }
+
+#ifdef _WIN32
+    void createWindowsGnuplotScript(const std::string& dataFile) const {
+        std::ofstream script("plot_script.plt");
+        if (!script.is_open()) return;
+
+        script << "# Скрипт Gnuplot для визуализации траектории\n";
+        script << "set terminal png size 1200,800 enhanced font 'Arial,12'\n";
+        script << "set output 'flight_trajectory.png'\n";
+        script << "set multiplot layout 2,2 title 'Динамика полета ТУ-154'\n\n";
+
+        script << "# График высоты\n";
+        script << "set title 'Изменение высоты'\n";
+        script << "set xlabel 'Время, с'\n";
+        script << "set ylabel 'Высота, м'\n";
+        script << "set grid\n";
+        script << "plot '" << dataFile << "' using 1:2 with lines lw 2 lc 'blue' title 'Высота'\n\n";
+
+        script << "# График скорости\n";
+        script << "set title 'Изменение скорости'\n";
+        script << "set xlabel 'Время, с'\n";
+        script << "set ylabel 'Скорость, км/ч'\n";
+        script << "set grid\n";
+        script << "plot '" << dataFile << "' using 1:3 with lines lw 2 lc 'red' title 'Скорость'\n\n";
+
+        script << "unset multiplot\n";
+        script << "print 'График сохранен в файл flight_trajectory.png'\n";
+        script << "pause -1\n";
+
+        script.close();
+    }
+#endif
+};
+
+// ------------------------------------------------------------------
+// МОДЕЛЬ ЛЕТАТЕЛЬНОГО АППАРАТА
+// ------------------------------------------------------------------
+class AircraftModel {
+    const AtmosphereData* atmosphere = &AtmosphereData::standard();
+    double wingArea;
+    double massInitial;
+    const WindField* wind = nullptr;
+    WindField::Cursor windCursor;
+
+    // Плотность при том же давлении и температуре, отличной от МСА на tempDev
+    double airDensity(double altitude, double tempDev) const {
+        double rho = atmosphere->density(altitude);
+        if (tempDev == 0.0) return rho;
+        double tStd = atmosphere->temperature(altitude);
+        return rho * tStd / (tStd + tempDev);
+    }
+
+    WindSample windAt(double x, double h, double t) {
+        return wind ? wind->sample(x, h, t, windCursor) : WindSample{};
+    }
+
+public:
+    double massCurrent;
+    double thrust;
+    double throttle;           // положение РУД, тяга = THRUST_TOTAL * throttle * m / m0
+    double fuelBurnRate;
+    double dragCoeffZero;
+    double inducedDragCoeff;
+    double maxLiftCoeff;
+
+    AircraftModel(double mass = MASS_BASELINE, double area = WING_SPAN_AREA)
+        : wingArea(area), massInitial(mass), massCurrent(mass), throttle(THROTTLE_SETTING) {
+
+        thrust = THRUST_TOTAL * throttle;
+        fuelBurnRate = 2.5;                // кг/с
+        dragCoeffZero = 0.02;
+        inducedDragCoeff = 0.05;
+        maxLiftCoeff = 1.2;
+    }
+
+    double computeLiftCoeff(double aoa) const {
+        const double LIFT_SLOPE = 5.0;
+        return std::min(LIFT_SLOPE * aoa, maxLiftCoeff);
+    }
+
+    double computeDragCoeff(double liftCoeff) const {
+        return dragCoeffZero + inducedDragCoeff * liftCoeff * liftCoeff;
+    }
+
+    // Поле ветра не копируется и должно жить дольше модели
+    void setWindField(const WindField* field) {
+        wind = field;
+        windCursor = WindField::Cursor();
+    }
+
+    // velocity - воздушная скорость
+    double calculateLift(double velocity, double altitude, double aoa,
+        double tempDev = 0.0) const {
+        double dynamicPress = 0.5 * airDensity(altitude, tempDev) * velocity * velocity;
+        double cl = computeLiftCoeff(aoa);
+        return cl * wingArea * dynamicPress;
+    }
+
+    double calculateDrag(double velocity, double altitude, double aoa,
+        double tempDev = 0.0) const {
+        double dynamicPress = 0.5 * airDensity(altitude, tempDev) * velocity * velocity;
+        double cl = computeLiftCoeff(aoa);
+        double cd = computeDragCoeff(cl);
+        return cd * wingArea * dynamicPress;
+    }
+
+    FlightState propagateState(const FlightState& current,
+        double timeStep,
+        double commandedAOA) {
+        FlightState next = current;
+
+        // Ограничение угла атаки
+        commandedAOA = std::max(-0.1, std::min(0.2, commandedAOA));
+
+        // Ветер в текущей точке: V - воздушная скорость, координаты
+        // интегрируются по путевой скорости
+        WindSample windHere = windAt(current.x, current.h, current.t);
+
+        // Расчет аэродинамических сил
+        double liftForce = calculateLift(current.V, current.h, commandedAOA, windHere.tempDev);
+        double dragForce = calculateDrag(current.V, current.h, commandedAOA, windHere.tempDev);
+
+        // Уравнения движения
+        double forceX = thrust - dragForce - massCurrent * G_CONST * sin(current.theta);
+        double forceY = liftForce - massCurrent * G_CONST * cos(current.theta);
+
+        double accelX = forceX / massCurrent;
+        double accelY = forceY / massCurrent;
+
+        // Интегрирование скорости
+        next.V = current.V + accelX * timeStep;
+        next.V = std::max(100.0, next.V);  // минимальная скорость
+
+        if (next.V > 0) {
+            next.theta = atan2(accelY, accelX + G_CONST * sin(current.theta));
+        }
+
+        next.theta = std::max(-0.3, std::min(0.3, next.theta));
+        next.Vh = next.V * cos(next.theta);
+        next.Vv = next.V * sin(next.theta);
+
+        // Интегрирование координат
+        next.x = current.x + (next.Vh + windHere.windX) * timeStep;
+        next.h = current.h + (next.Vv + windHere.windV) * timeStep;
+
+        // Защита от отрицательной высоты
+        if (next.h < 0) {
+            next.h = 10.0;
+            next.Vv = std::max(0.0, next.Vv);
+        }
+
+        // Обновление параметров
+        next.alpha = commandedAOA;
+        next.mach = atmosphere->machNumber(next.V, next.h);
+        if (wind) {
+            double tStd = atmosphere->temperature(next.h);
+            double tempDev = windAt(next.x, next.h, next.t + timeStep).tempDev;
+            next.mach /= std::sqrt((tStd + tempDev) / tStd);
+        }
+        next.accel = accelX;
+
+        double deltaFuel = fuelBurnRate * timeStep;
+        next.fuelUsed = current.fuelUsed + deltaFuel;
+        next.massCurr = current.massCurr - deltaFuel;
+
+        // Коррекция тяги (упрощенная модель)
+        thrust = THRUST_TOTAL * throttle * (next.massCurr / massInitial);
+
+        next.t = current.t + timeStep;
+
+        return next;
+    }
+
+    double initialMass() const { return massInitial; }
+    const AtmosphereData& atmosphereData() const { return *atmosphere; }
+
+    // Масса и тяга к началу расчета: propagateState меняет тягу по ходу полета
+    void resetState() {
+        massCurrent = massInitial;
+        thrust = THRUST_TOTAL * throttle;
+    }
+
+    // Другие масса и площадь крыла для копии готовой модели
+    void setAirframe(double mass, double area) {
+        massInitial = mass;
+        massCurrent = mass;
+        wingArea = area;
+    }
+
+    // Все входные параметры расчета; massCurrent и thrust - состояние,
+    // которое runSimulation сбрасывает через resetState
+    void hashInto(InputHasher& hasher) const {
+        atmosphere->hashInto(hasher);
+        hasher.add(wingArea);
+        hasher.add(massInitial);
+        hasher.add(THRUST_TOTAL * throttle);
+        hasher.add(fuelBurnRate);
+        hasher.add(dragCoeffZero);
+        hasher.add(inducedDragCoeff);
+        hasher.add(maxLiftCoeff);
+        if (wind) wind->hashInto(hasher);
+        else hasher.add(static_cast<uint64_t>(0));
+    }
+};
+
+// ------------------------------------------------------------------
+// ЗАКОН УПРАВЛЕНИЯ УГЛОМ АТАКИ
+// ------------------------------------------------------------------
+struct ControlLawParams {
+    double climbFraction = 0.3;        // граница активного набора (доля ALT_TARGET)
+    double transitionFraction = 0.7;   // граница переходного режима
+    double aoaClimb = 0.06;            // активный набор высоты, рад
+    double aoaTransition = 0.04;       // переходный режим, рад
+    double aoaLevelOff = 0.02;         // вывод на заданную высоту, рад
+    double speedFraction = 0.9;        // порог коррекции по скорости (доля VEL_TARGET_MS)
+    double aoaSpeedCorrection = 0.01;  // уменьшение угла атаки для разгона, рад
+
+    double command(const FlightState& state) const {
+        double heightFraction = state.h / ALT_TARGET;
+        double aoaCommand;
+
+        if (heightFraction < climbFraction) {
+            aoaCommand = aoaClimb;
+        }
+        else if (heightFraction < transitionFraction) {
+            aoaCommand = aoaTransition;
+        }
+        else {
+            aoaCommand = aoaLevelOff;
+        }
+
+        if (state.V < VEL_TARGET_MS * speedFraction) {
+            aoaCommand -= aoaSpeedCorrection;
+        }
+        return aoaCommand;
+    }
+
+    void hashInto(InputHasher& hasher) const {
+        hasher.add(climbFraction);
+        hasher.add(transitionFraction);
+        hasher.add(aoaClimb);
+        hasher.add(aoaTransition);
+        hasher.add(aoaLevelOff);
+        hasher.add(speedFraction);
+        hasher.add(aoaSpeedCorrection);
+    }
+};
+
+// ------------------------------------------------------------------
+// КЭШ РЕЗУЛЬТАТОВ МОДЕЛИРОВАНИЯ НА ДИСКЕ
+// ------------------------------------------------------------------
+// Версия модели: увеличивать при любом изменении уравнений движения,
+// иначе кэш вернет результаты старой модели
+const uint64_t SIM_MODEL_VERSION = 1;
+
+struct SimulationSummary {
+    FlightState finalState;
+    uint64_t pointCount = 0;
+    bool targetAchieved = false;
+    bool aborted = false;       // выход за допустимые пределы
+    double finalThrust = 0;     // тяга модели после расчета
+};
+
+class SimulationCache {
+    std::filesystem::path cacheDir;
+    bool storeTrajectories;
+    size_t hitCount = 0;
+    size_t missCount = 0;
+
+    static constexpr uint32_t SUMMARY_MAGIC = 0x53554d31;   // "SUM1"
+    static constexpr uint32_t TRAJECTORY_MAGIC = 0x54524a31; // "TRJ1"
+
+    std::filesystem::path entryPath(const std::string& key, const char* ext) const {
+        return cacheDir / (key + ext);
+    }
+
+    // Запись через временный файл: прерванный расчет не оставит битую запись
+    static bool writeAtomically(const std::filesystem::path& target,
+        const std::string& bytes) {
+        std::filesystem::path tmp = target;
+        tmp += ".tmp";
+        {
+            std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+            if (!out.is_open()) return false;
+            out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+            if (!out) return false;
+        }
+        std::error_code ec;
+        std::filesystem::rename(tmp, target, ec);
+        if (ec) {
+            std::filesystem::remove(tmp, ec);
+            return false;
+        }
+        return true;
+    }
+
+    template <typename T>
+    static void appendRaw(std::string& bytes, const T& value) {
+        bytes.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    template <typename T>
+    static bool readRaw(std::ifstream& in, T& value) {
+        return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(T)));
+    }
+
+    bool readSummary(const std::string& key, SimulationSummary& summary) const {
+        std::ifstream in(entryPath(key, ".sum"), std::ios::binary);
+        uint32_t magic = 0;
+        uint8_t flags = 0;
+        bool ok = in.is_open() && readRaw(in, magic) && magic == SUMMARY_MAGIC &&
+            readRaw(in, summary.finalState) && readRaw(in, summary.pointCount) &&
+            readRaw(in, flags) && readRaw(in, summary.finalThrust);
+        if (ok) {
+            summary.targetAchieved = (flags & 1) != 0;
+            summary.aborted = (flags & 2) != 0;
+        }
+        return ok;
+    }
+
+    // Число точек сверяется с размером файла: битая или обрезанная запись - промах
+    bool readTrajectory(const std::string& key, FlightPath& path) const {
+        std::filesystem::path file = entryPath(key, ".traj");
+        std::error_code ec;
+        uintmax_t size = std::filesystem::file_size(file, ec);
+        const uintmax_t headerSize = sizeof(uint32_t) + sizeof(uint64_t);
+        if (ec || size < headerSize) return false;
+        std::ifstream in(file, std::ios::binary);
+        uint32_t magic = 0;
+        uint64_t count = 0;
+        if (!in.is_open() || !readRaw(in, magic) || magic != TRAJECTORY_MAGIC ||
+            !readRaw(in, count)) {
+            return false;
+        }
+        if ((size - headerSize) % sizeof(FlightState) != 0 ||
+            count != (size - headerSize) / sizeof(FlightState)) {
+            return false;
+        }
+        std::vector<FlightState> points(count);
+        if (!in.read(reinterpret_cast<char*>(points.data()),
+            static_cast<std::streamsize>(count * sizeof(FlightState)))) {
+            return false;
+        }
+        path = FlightPath();
+        for (const auto& pt : points) path.appendPoint(pt);
+        return true;
+    }
+
+    bool countLookup(bool hit) {
+        hit ? ++hitCount : ++missCount;
+        return hit;
+    }
+
+public:
+    explicit SimulationCache(const std::string& dir, bool withTrajectories = false)
+        : cacheDir(dir), storeTrajectories(withTrajectories) {
+        std::error_code ec;
+        std::filesystem::create_directories(cacheDir, ec);
+        if (ec) {
+            throw std::runtime_error("Не удалось создать каталог кэша " + dir);
+        }
+    }
+
+    static std::string makeKey(const AircraftModel& aircraft,
+        const ControlLawParams& law, double timeStep, double maxTime) {
+        InputHasher hasher;
+        hasher.add(SIM_MODEL_VERSION);
+        aircraft.hashInto(hasher);
+        law.hashInto(hasher);
+        hasher.add(timeStep);
+        hasher.add(maxTime);
+        hasher.add(ALT_START);
+        hasher.add(ALT_TARGET);
+        hasher.add(VEL_INITIAL_MS);
+        hasher.add(VEL_TARGET_MS);
+        return hasher.hex();
+    }
+
+    bool keepsTrajectories() const { return storeTrajectories; }
+
+    bool loadSummary(const std::string& key, SimulationSummary& summary) {
+        return countLookup(readSummary(key, summary));
+    }
+
+    // Итог и траектория вместе: одно обращение - одно попадание или промах
+    bool loadEntry(const std::string& key, SimulationSummary& summary, FlightPath& path) {
+        return countLookup(readSummary(key, summary) && readTrajectory(key, path));
+    }
+
+    void store(const std::string& key, const SimulationSummary& summary,
+        const FlightPath* path) {
+        std::string bytes;
+        appendRaw(bytes, SUMMARY_MAGIC);
+        appendRaw(bytes, summary.finalState);
+        appendRaw(bytes, summary.pointCount);
+        uint8_t flags = (summary.targetAchieved ? 1 : 0) | (summary.aborted ? 2 : 0);
+        appendRaw(bytes, flags);
+        appendRaw(bytes, summary.finalThrust);
+        writeAtomically(entryPath(key, ".sum"), bytes);
+
+        if (path && storeTrajectories) {
+            const auto& points = path->getAllPoints();
+            std::string traj;
+            traj.reserve(sizeof(uint32_t) + sizeof(uint64_t) +
+                points.size() * sizeof(FlightState));
+            appendRaw(traj, TRAJECTORY_MAGIC);
+            appendRaw(traj, static_cast<uint64_t>(points.size()));
+            traj.append(reinterpret_cast<const char*>(points.data()),
+                points.size() * sizeof(FlightState));
+            writeAtomically(entryPath(key, ".traj"), traj);
+        }
+    }
+
+    size_t hits() const { return hitCount; }
+    size_t misses() const { return missCount; }
+};
+
+// ------------------------------------------------------------------
+// КОНТРОЛЬНЫЕ ТОЧКИ МОДЕЛИРОВАНИЯ
+// ------------------------------------------------------------------
+// Полное состояние расчета на момент state.t: вектор состояния и
+// изменяемые параметры модели. Годится только для той же модели и шага.
+struct SimulationCheckpoint {
+    FlightState state;
+    double massCurrent = 0;
+    double thrust = 0;
+    size_t pathSize = 0;    // число точек траектории, последняя из них - state
+    int iteration = 0;
+};
+
+// ------------------------------------------------------------------
+// АЛГОРИТМ ОПТИМИЗАЦИИ ТРАЕКТОРИИ
+// ------------------------------------------------------------------
+class TrajectoryOptimizer {
+    ControlLawParams controlLaw;
+    double timeStep = 1.0;
+    SimulationCache* cache = nullptr;
+    bool verbose = true;
+    double checkpointInterval = 0;      // 0 - контрольные точки не пишутся
+    std::vector<SimulationCheckpoint> checkpoints;
+    double realTimeRate = 0;            // 0 - расчет без привязки к часам
+    RealTimePacer pacer;
+
+public:
+    TrajectoryOptimizer() = default;
+
+    void setControlLaw(const ControlLawParams& law) { controlLaw = law; }
+    const ControlLawParams& getControlLaw() const { return controlLaw; }
+    void setTimeStep(double dt) { timeStep = dt; }
+    void setCache(SimulationCache* simCache) { cache = simCache; }
+    void setVerbose(bool enabled) { verbose = enabled; }
+
+    // Запись контрольных точек каждые interval секунд модельного времени
+    void setCheckpointInterval(double interval) { checkpointInterval = interval; }
+    const std::vector<SimulationCheckpoint>& lastCheckpoints() const { return checkpoints; }
+
+    // Тактирование по реальному времени: rate = 1 - секунда модели за
+    // секунду часов, rate = 2 - вдвое быстрее. Кэш в этом режиме не используется.
+    void setRealTime(double rate) { realTimeRate = rate; }
+    const RealTimePacer& realTimeStats() const { return pacer; }
+
+    // Досчет после смены закона управления: basePath и baseCheckpoints
+    // получены с законом baseLaw, новый закон - текущий. Момент
+    // расхождения находится по первой точке, где команды законов различаются.
+    FlightPath resimulate(AircraftModel& aircraft, const FlightPath& basePath,
+        const std::vector<SimulationCheckpoint>& baseCheckpoints,
+        const ControlLawParams& baseLaw, double maxTime = 600.0) {
+        const auto& points = basePath.getAllPoints();
+        double changeTime = points.empty() ? 0.0 : points.back().t;
+        for (const auto& pt : points) {
+            if (baseLaw.command(pt) != controlLaw.command(pt)) {
+                changeTime = pt.t;
+                break;
+            }
+        }
+        return resimulateAfter(aircraft, basePath, baseCheckpoints, changeTime, maxTime);
+    }
+
+    // Досчет, когда закон управления изменен только начиная с момента changeTime
+    FlightPath resimulateAfter(AircraftModel& aircraft, const FlightPath& basePath,
+        const std::vector<SimulationCheckpoint>& baseCheckpoints,
+        double changeTime, double maxTime = 600.0) {
+        auto it = std::upper_bound(baseCheckpoints.begin(), baseCheckpoints.end(), changeTime,
+            [](double t, const SimulationCheckpoint& cp) { return t < cp.state.t; });
+        if (it == baseCheckpoints.begin() ||
+            std::prev(it)->pathSize > basePath.getAllPoints().size()) {
+            // Нет подходящей контрольной точки - полный расчет
+            FlightPath resultPath;
+            runSimulation(aircraft, maxTime, &resultPath, nullptr);
+            return resultPath;
+        }
+
+        // Копия: baseCheckpoints может ссылаться на this->checkpoints
+        SimulationCheckpoint resumePoint = *std::prev(it);
+        std::vector<SimulationCheckpoint> prefix(baseCheckpoints.begin(), it);
+        FlightPath resultPath = basePath;
+        resultPath.truncate(resumePoint.pathSize);
+        checkpoints = std::move(prefix);
+        runSimulation(aircraft, maxTime, &resultPath, &resumePoint);
+        return resultPath;
+    }
+
+    FlightPath computeOptimalPath(AircraftModel& aircraft,
+        double maxTime = 600.0) {
+        SimulationCache* cache = realTimeRate > 0 ? nullptr : this->cache;
+        std::string key;
+        if (cache) {
+            key = SimulationCache::makeKey(aircraft, controlLaw, timeStep, maxTime);
+            FlightPath cachedPath;
+            SimulationSummary cached;
+            if (cache->loadEntry(key, cached, cachedPath)) {
+                // Контрольные точки прошлого расчета к этой траектории не относятся:
+                // resimulate без них выполнит полный расчет
+                checkpoints.clear();
+                aircraft.resetState();
+                aircraft.thrust = cached.finalThrust;
+                if (verbose) {
+                    std::cout << "\nРезультат взят из кэша (" << key << ")\n";
+                    printResults(cached.finalState);
+                }
+                return cachedPath;
+            }
+        }
+
+        FlightPath resultPath;
+        SimulationSummary summary = runSimulation(aircraft, maxTime, &resultPath, nullptr);
+        if (cache) cache->store(key, summary, &resultPath);
+        return resultPath;
+    }
+
+    // Только итоговые параметры: для серийных расчетов и таблиц
+    SimulationSummary computeSummary(AircraftModel& aircraft,
+        double maxTime = 600.0) {
+        SimulationCache* cache = realTimeRate > 0 ? nullptr : this->cache;
+        std::string key;
+        SimulationSummary summary;
+        if (cache) {
+            key = SimulationCache::makeKey(aircraft, controlLaw, timeStep, maxTime);
+            if (cache->loadSummary(key, summary)) {
+                checkpoints.clear();
+                aircraft.resetState();
+                aircraft.thrust = summary.finalThrust;
+                return summary;
+            }
+        }
+
+        if (cache && cache->keepsTrajectories()) {
+            FlightPath resultPath;
+            summary = runSimulation(aircraft, maxTime, &resultPath, nullptr);
+            cache->store(key, summary, &resultPath);
+        }
+        else {
+            summary = runSimulation(aircraft, maxTime, nullptr, nullptr);
+            if (cache) cache->store(key, summary, nullptr);
+        }
+        return summary;
+    }
+
+private:
+    // resumeFrom != nullptr: продолжение с контрольной точки, resultPath
+    // уже содержит префикс траектории до нее включительно
+    SimulationSummary runSimulation(AircraftModel& aircraft, double maxTime,
+        FlightPath* resultPath, const SimulationCheckpoint* resumeFrom) {
+        if (!resumeFrom) checkpoints.clear();
+
+        // Начальные условия
+        FlightState initialState;
+        initialState.t = 0;
+        initialState.x = 0;
+        initialState.h = ALT_START;
+        initialState.V = VEL_INITIAL_MS;
+        initialState.Vh = VEL_INITIAL_MS;
+        initialState.Vv = 5.0;
+        initialState.theta = 0.05;
+        initialState.alpha = 0.03;
+        initialState.fuelUsed = 0;
+        initialState.massCurr = aircraft.initialMass();
+        initialState.accel = 0;
+
+        initialState.mach = aircraft.atmosphereData().machNumber(initialState.V, initialState.h);
+
+        FlightState currentState = initialState;
+        SimulationSummary summary;
+        int iteration = 0;
+
+        if (resumeFrom) {
+            currentState = resumeFrom->state;
+            aircraft.massCurrent = resumeFrom->massCurrent;
+            aircraft.thrust = resumeFrom->thrust;
+            iteration = resumeFrom->iteration;
+            summary.pointCount = resumeFrom->pathSize;
+        }
+        else {
+            aircraft.resetState();
+            if (resultPath) resultPath->appendPoint(currentState);
+            summary.pointCount = 1;
+        }
+
+        double nextCheckpointTime = resumeFrom ?
+            currentState.t + checkpointInterval : currentState.t;
+        auto recordCheckpoint = [&]() {
+            if (checkpointInterval <= 0 || currentState.t < nextCheckpointTime) return;
+            checkpoints.push_back({ currentState, aircraft.massCurrent, aircraft.thrust,
+                static_cast<size_t>(summary.pointCount), iteration });
+            nextCheckpointTime = currentState.t + checkpointInterval;
+        };
+        recordCheckpoint();
+
+        if (verbose) {
+            std::cout << "\n=== ПАРАМЕТРЫ МОДЕЛИРОВАНИЯ ===\n";
+            std::cout << "Целевая высота: " << ALT_TARGET << " м\n";
+            std::cout << "Целевая скорость: " << VEL_TARGET_KPH << " км/ч\n";
+            std::cout << "Максимальное время: " << maxTime << " с\n";
+            if (resumeFrom) {
+                std::cout << "Продолжение с контрольной точки t = "
+                    << resumeFrom->state.t << " с\n";
+            }
+            std::cout << "\n";
+        }
+
+        const bool paced = realTimeRate > 0;
+        if (paced) pacer.start(timeStep, realTimeRate);
+
+        while (currentState.t < maxTime && !summary.targetAchieved) {
+            iteration++;
+            if (paced) pacer.beginStep();
+
+            double aoaCommand = controlLaw.command(currentState);
+
+            currentState = aircraft.propagateState(currentState,
+                timeStep,
+                aoaCommand);
+            if (resultPath) resultPath->appendPoint(currentState);
+            summary.pointCount++;
+
+            // Периодический вывод информации
+            if (verbose && iteration % 30 == 0) {
+                std::cout << "Шаг " << iteration << " | ";
+                std::cout << "Время: " << currentState.t << "с | ";
+                std::cout << "Высота: " << currentState.h << "м | ";
+                std::cout << "Скорость: " << currentState.V * 3.6 << "км/ч\n";
+            }
+
+            // Проверка достижения цели
+            if (currentState.h >= ALT_TARGET) {
+                summary.targetAchieved = true;
+                if (verbose) std::cout << "\n>>> ЦЕЛЕВАЯ ВЫСОТА ДОСТИГНУТА! <<<\n";
+            }
+
+            // Проверка на нефизичные значения
+            if (currentState.h > 20000 || currentState.V > 1000) {
+                summary.aborted = true;
+                if (verbose) std::cout << "\n!!! Прерывание: выход за допустимые пределы\n";
+                break;
+            }
+
+            if (!summary.targetAchieved) recordCheckpoint();
+
+            // Вывод и контрольные точки тоже входят в шаг: иначе они
+            // незаметно съедают бюджет следующего
+            if (paced) pacer.endStep();
+        }
+
+        if (verbose) {
+            printResults(currentState);
+            if (paced) pacer.printReport();
+        }
+
+        summary.finalState = currentState;
+        summary.finalThrust = aircraft.thrust;
+        return summary;
+    }
+
+    void printResults(const FlightState& finalState) const {
+        std::cout << "\n=== РЕЗУЛЬТАТЫ МОДЕЛИРОВАНИЯ ===\n";
+        std::cout << "Финальная высота: " << finalState.h << " м ("
+            << (finalState.h / ALT_TARGET * 100) << "% от цели)\n";
+        std::cout << "Финальная скорость: " << finalState.V * 3.6 << " км/ч\n";
+        std::cout << "Общее время: " << finalState.t << " с\n";
+        std::cout << "Расход топлива: " << finalState.fuelUsed << " кг\n";
+        std::cout << "Число Маха: " << finalState.mach << "\n";
+    }
+};
+
+// ------------------------------------------------------------------
+// ПУЛ РАБОЧИХ ПОТОКОВ
+// ------------------------------------------------------------------
+class WorkerPool {
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex queueMutex;
+    std::condition_variable queueChanged;
+    size_t activeTasks = 0;
+    bool stopping = false;
+
+    void workerLoop() {
+        for (;;) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(queueMutex);
+                queueChanged.wait(lock, [this] { return stopping || !tasks.empty(); });
+                if (tasks.empty()) return;
+                task = std::move(tasks.front());
+                tasks.pop_front();
+                ++activeTasks;
+            }
+            task();
+            {
+                std::lock_guard<std::mutex> lock(queueMutex);
+                --activeTasks;
+            }
+            queueChanged.notify_all();
+        }
+    }
+
+public:
+    explicit WorkerPool(size_t threadCount) {
+        if (threadCount == 0) threadCount = 1;
+        for (size_t i = 0; i < threadCount; ++i) {
+            workers.emplace_back([this] { workerLoop(); });
+        }
+    }
+
+    ~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            stopping = true;
+        }
+        queueChanged.notify_all();
+        for (auto& w : workers) w.join();
+    }
+
+    void submit(std::function<void()> task) {
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            tasks.push_back(std::move(task));
+        }
+        queueChanged.notify_all();
+    }
+
+    // false - в очереди уже maxQueued задач, задача не принята
+    bool trySubmit(std::function<void()> task, size_t maxQueued) {
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            if (tasks.size() >= maxQueued) return false;
+            tasks.push_back(std::move(task));
+        }
+        queueChanged.notify_all();
+        return true;
+    }
+
+    // Ожидание выполнения всех поставленных задач
+    void waitIdle() {
+        std::unique_lock<std::mutex> lock(queueMutex);
+        queueChanged.wait(lock, [this] { return tasks.empty() && activeTasks == 0; });
+    }
+
+    size_t size() const { return workers.size(); }
+};
+
+// ------------------------------------------------------------------
+// РАЗБОР ПЛОСКОГО JSON-ОБЪЕКТА ОДНОЙ СТРОКИ ЗАПРОСА
+// ------------------------------------------------------------------
+// Поддерживаются значения: число, строка, true/false, null.
+// Вложенные объекты и массивы в запросах не нужны и считаются ошибкой.
+class JsonLine {
+public:
+    struct Value {
+        enum Kind { NUMBER, STRING, BOOL, NUL } kind = NUL;
+        double number = 0;
+        std::string text;       // строка без кавычек
+        std::string raw;        // исходная запись значения
+    };
+
+    bool parse(const std::string& line, std::string& error) {
+        values.clear();
+        pos = 0;
+        src = &line;
+        skipSpaces();
+        if (!consume('{')) return fail(error, "ожидался объект JSON");
+        skipSpaces();
+        if (consume('}')) return finish(error);
+        for (;;) {
+            std::string key;
+            skipSpaces();
+            if (!parseString(key)) return fail(error, "ожидалось имя поля");
+            skipSpaces();
+            if (!consume(':')) return fail(error, "ожидалось ':'");
+            skipSpaces();
+            Value value;
+            if (!parseValue(value)) return fail(error, "неверное значение поля " + key);
+            values[key] = value;
+            skipSpaces();
+            if (consume(',')) continue;
+            if (consume('}')) return finish(error);
+            return fail(error, "ожидалось ',' или '}'");
+        }
+    }
+
+    const std::map<std::string, Value>& fields() const { return values; }
+
+    const Value* find(const std::string& key) const {
+        auto it = values.find(key);
+        return it == values.end() ? nullptr : &it->second;
+    }
+
+    static std::string escape(const std::string& text) {
+        std::string out;
+        for (char c : text) {
+            if (c == '"' || c == '\\') { out += '\\'; out += c; }
+            else if (c == '\n') out += "\\n";
+            else if (static_cast<unsigned char>(c) < 0x20) out += ' ';
+            else out += c;
+        }
+        return out;
+    }
+
+private:
+    std::map<std::string, Value> values;
+    const std::string* src = nullptr;
+    size_t pos = 0;
+
+    bool fail(std::string& error, const std::string& message) {
+        error = message + " (позиция " + std::to_string(pos) + ")";
+        return false;
+    }
+
+    bool finish(std::string& error) {
+        skipSpaces();
+        if (pos != src->size()) return fail(error, "лишние символы после объекта");
+        return true;
+    }
+
+    void skipSpaces() {
+        while (pos < src->size() && std::isspace(static_cast<unsigned char>((*src)[pos]))) ++pos;
+    }
+
+    bool consume(char c) {
+        if (pos < src->size() && (*src)[pos] == c) { ++pos; return true; }
+        return false;
+    }
+
+    bool consumeWord(const char* word) {
+        size_t len = std::strlen(word);
+        if (src->compare(pos, len, word) != 0) return false;
+        pos += len;
+        return true;
+    }
+
+    bool parseString(std::string& out) {
+        if (!consume('"')) return false;
+        out.clear();
+        while (pos < src->size()) {
+            char c = (*src)[pos++];
+            if (c == '"') return true;
+            if (c != '\\') { out += c; continue; }
+            if (pos >= src->size()) return false;
+            char e = (*src)[pos++];
+            switch (e) {
+            case 'n': out += '\n'; break;
+            case 't': out += '\t'; break;
+            case 'r': out += '\r'; break;
+            case 'b': out += '\b'; break;
+            case 'f': out += '\f'; break;
+            case 'u':   // \uXXXX вне ASCII в запросах не ожидается
+                if (pos + 4 > src->size()) return false;
+                out += static_cast<char>(std::strtol(src->substr(pos, 4).c_str(), nullptr, 16) & 0x7f);
+                pos += 4;
+                break;
+            default: out += e; break;
+            }
+        }
+        return false;
+    }
+
+    bool parseValue(Value& value) {
+        size_t start = pos;
+        if (pos >= src->size()) return false;
+        char c = (*src)[pos];
+        if (c == '"') {
+            value.kind = Value::STRING;
+            if (!parseString(value.text)) return false;
+        }
+        else if (consumeWord("true")) {
+            value.kind = Value::BOOL;
+            value.number = 1;
+        }
+        else if (consumeWord("false")) {
+            value.kind = Value::BOOL;
+            value.number = 0;
+        }
+        else if (consumeWord("null")) {
+            value.kind = Value::NUL;
+        }
+        else {
+            // Только запись числа JSON: strtod принял бы и inf, nan, 0x1p3
+            size_t end = pos;
+            if (end < src->size() && (*src)[end] == '-') ++end;
+            if (end >= src->size() || !std::isdigit(static_cast<unsigned char>((*src)[end]))) return false;
+            while (end < src->size() && (std::isdigit(static_cast<unsigned char>((*src)[end])) ||
+                ((*src)[end] != '\0' && std::strchr(".eE+-", (*src)[end])))) ++end;
+            std::string text = src->substr(pos, end - pos);
+            char* parsed = nullptr;
+            value.number = std::strtod(text.c_str(), &parsed);
+            if (parsed != text.c_str() + text.size()) return false;
+            pos = end;
+            value.kind = Value::NUMBER;
+        }
+        value.raw = src->substr(start, pos - start);
+        return true;
+    }
+};
+
+// ------------------------------------------------------------------
+// СЛУЖБА МОДЕЛИРОВАНИЯ: ЗАПРОСЫ JSON LINES ЧЕРЕЗ STDIN ИЛИ UNIX-СОКЕТ
+// ------------------------------------------------------------------
+// Таблицы атмосферы и модель собираются один раз при старте, каждый
+// запрос получает копию прототипа и считается в пуле без вывода на консоль.
+// Пример запроса:  {"id": 7, "cmd": "simulate", "mass": 45000, "maxTime": 300}
+// Ответы приходят в порядке готовности, поле id возвращается как было.
+class SimulationService {
+    static const size_t MAX_STEPS = 200000;     // maxTime / dt одного запроса
+    static const size_t MAX_QUEUED = 1024;      // запросов в очереди пула
+    static const size_t MAX_CONNECTIONS = 256;  // открытых соединений сокета
+
+    AircraftModel prototype;
+    ControlLawParams defaultLaw;
+    WorkerPool pool;
+    std::atomic<uint64_t> served{ 0 };
+    std::atomic<uint64_t> failed{ 0 };
+
+    static bool applyNumber(const std::string& key, double value,
+        AircraftModel& aircraft, ControlLawParams& law, double& dt, double& maxTime) {
+        static const std::map<std::string, double AircraftModel::*> aircraftFields = {
+            { "throttle", &AircraftModel::throttle },
+            { "fuelBurnRate", &AircraftModel::fuelBurnRate },
+            { "dragCoeffZero", &AircraftModel::dragCoeffZero },
+            { "inducedDragCoeff", &AircraftModel::inducedDragCoeff },
+            { "maxLiftCoeff", &AircraftModel::maxLiftCoeff },
+        };
+        static const std::map<std::string, double ControlLawParams::*> lawFields = {
+            { "climbFraction", &ControlLawParams::climbFraction },
+            { "transitionFraction", &ControlLawParams::transitionFraction },
+            { "aoaClimb", &ControlLawParams::aoaClimb },
+            { "aoaTransition", &ControlLawParams::aoaTransition },
+            { "aoaLevelOff", &ControlLawParams::aoaLevelOff },
+            { "speedFraction", &ControlLawParams::speedFraction },
+            { "aoaSpeedCorrection", &ControlLawParams::aoaSpeedCorrection },
+        };
+        auto a = aircraftFields.find(key);
+        if (a != aircraftFields.end()) { aircraft.*(a->second) = value; return true; }
+        auto l = lawFields.find(key);
+        if (l != lawFields.end()) { law.*(l->second) = value; return true; }
+        if (key == "dt") { dt = value; return dt > 0; }
+        if (key == "maxTime") { maxTime = value; return maxTime >= 0; }
+        return false;
+    }
+
+    static bool positiveNumber(const JsonLine::Value& v) {
+        return v.kind == JsonLine::Value::NUMBER && std::isfinite(v.number) && v.number > 0;
+    }
+
+    static std::string number(double v) {
+        char buf[32];
+        std::snprintf(buf, sizeof(buf), "%.10g", v);
+        return buf;
+    }
+
+    std::string errorReply(const std::string& id, const std::string& message) {
+        ++failed;
+        return "{" + id + "\"ok\":false,\"error\":\"" + JsonLine::escape(message) + "\"}";
+    }
+
+    // Ответ на запрос, не принятый в переполненную очередь
+    std::string overloadedReply(const std::string& line) {
+        JsonLine request;
+        std::string error;
+        std::string id;
+        if (request.parse(line, error)) {
+            if (const JsonLine::Value* v = request.find("id")) id = "\"id\":" + v->raw + ",";
+        }
+        return errorReply(id, "служба перегружена, повторите запрос позже");
+    }
+
+public:
+    explicit SimulationService(size_t threads) : pool(threads) {}
+
+    // Обработка одной строки запроса, результат - одна строка ответа
+    std::string handle(const std::string& line) {
+        JsonLine request;
+        std::string error;
+        if (!request.parse(line, error)) return errorReply("", error);
+
+        std::string id;
+        if (const JsonLine::Value* v = request.find("id")) id = "\"id\":" + v->raw + ",";
+
+        std::string cmd = "simulate";
+        if (const JsonLine::Value* v = request.find("cmd")) cmd = v->text;
+
+        if (cmd == "ping") {
+            ++served;
+            return "{" + id + "\"ok\":true}";
+        }
+        if (cmd == "stats") {
+            ++served;
+            return "{" + id + "\"ok\":true,\"served\":" + std::to_string(served.load()) +
+                ",\"failed\":" + std::to_string(failed.load()) +
+                ",\"threads\":" + std::to_string(pool.size()) + "}";
+        }
+        if (cmd != "simulate") return errorReply(id, "неизвестная команда " + cmd);
+
+        AircraftModel aircraft = prototype;
+        double mass = prototype.initialMass();
+        double area = WING_SPAN_AREA;
+        if (const JsonLine::Value* v = request.find("mass")) {
+            if (!positiveNumber(*v)) return errorReply(id, "mass: нужно конечное число > 0");
+            mass = v->number;
+        }
+        if (const JsonLine::Value* v = request.find("wingArea")) {
+            if (!positiveNumber(*v)) return errorReply(id, "wingArea: нужно конечное число > 0");
+            area = v->number;
+        }
+        aircraft.setAirframe(mass, area);
+        ControlLawParams law = defaultLaw;
+        double dt = 1.0;
+        double maxTime = 600.0;
+
+        for (const auto& field : request.fields()) {
+            const std::string& key = field.first;
+            if (key == "id" || key == "cmd" || key == "mass" || key == "wingArea") continue;
+            if (field.second.kind != JsonLine::Value::NUMBER || !std::isfinite(field.second.number) ||
+                !applyNumber(key, field.second.number, aircraft, law, dt, maxTime)) {
+                return errorReply(id, "неверный параметр " + key);
+            }
+        }
+        if (maxTime / dt > MAX_STEPS) {
+            return errorReply(id, "слишком много шагов: maxTime / dt > " + std::to_string(MAX_STEPS));
+        }
+
+        TrajectoryOptimizer optimizer;
+        optimizer.setVerbose(false);
+        optimizer.setControlLaw(law);
+        optimizer.setTimeStep(dt);
+        SimulationSummary summary = optimizer.computeSummary(aircraft, maxTime);
+        ++served;
+
+        const FlightState& f = summary.finalState;
+        return "{" + id + "\"ok\":true" +
+            ",\"finalAltitude\":" + number(f.h) +
+            ",\"finalSpeedKph\":" + number(f.V * 3.6) +
+            ",\"time\":" + number(f.t) +
+            ",\"fuelUsed\":" + number(f.fuelUsed) +
+            ",\"mach\":" + number(f.mach) +
+            ",\"distance\":" + number(f.x) +
+            ",\"points\":" + std::to_string(summary.pointCount) +
+            ",\"targetAchieved\":" + (summary.targetAchieved ? "true" : "false") +
+            ",\"aborted\":" + (summary.aborted ? "true" : "false") + "}";
+    }
+
+    // Запросы из input, ответы в output (режим --serve)
+    void serveStream(std::istream& input, std::ostream& output) {
+        std::mutex outputMutex;
+        std::string line;
+        while (std::getline(input, line)) {
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            if (line.empty()) continue;
+            bool queued = pool.trySubmit([this, line, &output, &outputMutex] {
+                std::string reply = handle(line);
+                std::lock_guard<std::mutex> lock(outputMutex);
+                output << reply << '\n';
+                output.flush();
+            }, MAX_QUEUED);
+            if (!queued) {
+                std::string reply = overloadedReply(line);
+                std::lock_guard<std::mutex> lock(outputMutex);
+                output << reply << '\n';
+                output.flush();
+            }
+        }
+        pool.waitIdle();
+    }
+
+#ifndef _WIN32
+    // Режим --serve-socket: все соединения опрашиваются одним потоком через poll,
+    // расчеты выполняются в общем пуле. Сверх MAX_CONNECTIONS новые
+    // соединения ждут в очереди listen.
+    void serveSocket(const std::string& socketPath) {
+        int listenFd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listenFd < 0) throw std::runtime_error("Не удалось создать сокет");
+
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        if (socketPath.size() >= sizeof(addr.sun_path)) {
+            ::close(listenFd);
+            throw std::runtime_error("Слишком длинный путь сокета " + socketPath);
+        }
+        std::strncpy(addr.sun_path, socketPath.c_str(), sizeof(addr.sun_path) - 1);
+        ::unlink(socketPath.c_str());
+        if (::bind(listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 ||
+            ::listen(listenFd, 64) < 0) {
+            ::close(listenFd);
+            throw std::runtime_error("Не удалось открыть сокет " + socketPath);
+        }
+        std::cout << "Служба моделирования слушает " << socketPath
+            << " (потоков: " << pool.size() << ")\n";
+
+        std::vector<pollfd> fds{ { listenFd, POLLIN, 0 } };
+        std::vector<Client> clients;        // clients[i] соответствует fds[i + 1]
+        char buf[65536];
+        for (;;) {
+            fds[0].events = clients.size() < MAX_CONNECTIONS ? POLLIN : 0;
+            if (::poll(fds.data(), fds.size(), -1) < 0) {
+                if (errno == EINTR) continue;
+                int err = errno;
+                ::close(listenFd);
+                throw std::runtime_error("Ошибка poll: " + std::string(std::strerror(err)));
+            }
+
+            // С конца: закрытое соединение заменяется последним, уже проверенным
+            for (size_t i = fds.size() - 1; i > 0; --i) {
+                if (fds[i].revents == 0) continue;
+                Client& client = clients[i - 1];
+                ssize_t n = ::recv(fds[i].fd, buf, sizeof(buf), 0);
+                if (n > 0) {
+                    client.pending.append(buf, static_cast<size_t>(n));
+                    submitLines(client);
+                    continue;
+                }
+                if (n < 0 && errno == EINTR) continue;
+                // Дескриптор закроется, когда пул отправит последний ответ
+                std::swap(fds[i], fds.back());
+                fds.pop_back();
+                std::swap(client, clients.back());
+                clients.pop_back();
+            }
+
+            if (fds[0].revents & POLLIN) {
+                int clientFd = ::accept(listenFd, nullptr, nullptr);
+                if (clientFd >= 0) {
+                    fds.push_back({ clientFd, POLLIN, 0 });
+                    clients.push_back({ std::make_shared<Connection>(clientFd), std::string() });
+                }
+                // Нехватка дескрипторов или памяти: пауза вместо холостого цикла
+                else if (errno == EMFILE || errno == ENFILE || errno == ENOBUFS || errno == ENOMEM) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                }
+                else if (errno != EINTR && errno != ECONNABORTED && errno != EAGAIN) {
+                    int err = errno;
+                    ::close(listenFd);
+                    throw std::runtime_error("Ошибка accept: " + std::string(std::strerror(err)));
+                }
+            }
+        }
+    }
+
+private:
+    struct Connection {
+        int fd;
+        std::mutex writeMutex;
+        explicit Connection(int descriptor) : fd(descriptor) {}
+        ~Connection() { ::close(fd); }
+
+        void send(const std::string& reply) {
+            std::lock_guard<std::mutex> lock(writeMutex);
+            std::string data = reply + '\n';
+            size_t sent = 0;
+            while (sent < data.size()) {
+                ssize_t n = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+                if (n <= 0) return;
+                sent += static_cast<size_t>(n);
+            }
+        }
+    };
+
+    struct Client {
+        std::shared_ptr<Connection> connection;
+        std::string pending;    // начало строки, еще не дошедшей до '\n'
+    };
+
+    // Полные строки из pending уходят в пул, остаток ждет следующего recv
+    void submitLines(Client& client) {
+        std::string& pending = client.pending;
+        size_t start = 0;
+        size_t newline;
+        while ((newline = pending.find('\n', start)) != std::string::npos) {
+            std::string line = pending.substr(start, newline - start);
+            start = newline + 1;
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            if (line.empty()) continue;
+            std::shared_ptr<Connection> connection = client.connection;
+            if (!pool.trySubmit([this, connection, line] { connection->send(handle(line)); },
+                MAX_QUEUED)) {
+                connection->send(overloadedReply(line));
+            }
+        }
+        pending.erase(0, start);
+    }
+#endif
+};
+
+// ------------------------------------------------------------------
+// ОСНОВНАЯ ФУНКЦИЯ
+// ------------------------------------------------------------------
+// SUPER_MEGA_NO_MAIN - для сборки вместе с Super_mega_dz_tests.cpp
+#ifndef SUPER_MEGA_NO_MAIN
+int main(int argc, char* argv[]) {
+    setlocale(LC_ALL, "ru");
+    try {
+        // --serve: запросы JSON lines из stdin, --serve-socket <путь>: через
+        // UNIX-сокет, --threads <n>: размер пула расчетов
+        size_t threads = std::max(1u, std::thread::hardware_concurrency());
+        std::string socketPath;
+        bool serveStdin = false;
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--serve") serveStdin = true;
+            else if (arg == "--serve-socket" && i + 1 < argc) socketPath = argv[++i];
+            else if (arg == "--threads" && i + 1 < argc) threads = std::max(1, std::atoi(argv[++i]));
+        }
+        if (serveStdin) {
+            SimulationService service(threads);
+            service.serveStream(std::cin, std::cout);
+            return EXIT_SUCCESS;
+        }
+        if (!socketPath.empty()) {
+#ifndef _WIN32
+            SimulationService service(threads);
+            service.serveSocket(socketPath);
+            return EXIT_SUCCESS;
+#else
+            throw std::runtime_error("Режим --serve-socket доступен только в POSIX-системах");
+#endif
+        }
+
+        AircraftModel tu134Model;
+        TrajectoryOptimizer optimizer;
+
+        // --cache <каталог>: повторные расчеты с теми же входными данными
+        // берутся из кэша без моделирования
+        std::unique_ptr<SimulationCache> cache;
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--cache" && i + 1 < argc) {
+                cache = std::make_unique<SimulationCache>(argv[++i], true);
+                optimizer.setCache(cache.get());
+            }
+            // --realtime <rate>: шаг модели в темпе реального времени
+            else if (arg == "--realtime" && i + 1 < argc) {
+                const char* text = argv[++i];
+                char* end = nullptr;
+                double rate = std::strtod(text, &end);
+                if (end == text || *end != '\0' || !std::isfinite(rate) || rate <= 0) {
+                    throw std::invalid_argument(
+                        "--realtime ожидает положительное число, получено '" + std::string(text) + "'");
+                }
+                optimizer.setRealTime(rate);
+            }
+        }
+
+        FlightPath trajectory = optimizer.computeOptimalPath(tu134Model, 300.0);
+
+        trajectory.exportToCSV("flight_profile_tu154.csv");
+        trajectory.visualize();
+
+    }
+    catch (const std::exception& err) {
+        std::cerr << "КРИТИЧЕСКАЯ ОШИБКА: " << err.what() << '\n';
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+#endif
\ No newline at end of file
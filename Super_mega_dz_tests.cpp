@@ -0,0 +1,431 @@
+// Проверки подсистем Super_mega_dz.cpp и realtime_pacer.h.
+// Сборка: g++ -std=c++17 -O2 -pthread Super_mega_dz_tests.cpp -o Super_mega_dz_tests
+// Рабочие файлы создаются во временном каталоге и удаляются после прогона.
+#define SUPER_MEGA_NO_MAIN
+#include "Super_mega_dz.cpp"
+
+#ifndef _WIN32
+#include <csignal>
+#include <sys/wait.h>
+#endif
+
+static int failures = 0;
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": не выполнено " #cond "\n"; \
+            failures++; \
+        } \
+    } while (0)
+
+static std::filesystem::path workDir;
+
+static bool samePath(const FlightPath& a, const FlightPath& b) {
+    const auto& pa = a.getAllPoints();
+    const auto& pb = b.getAllPoints();
+    return pa.size() == pb.size() &&
+        (pa.empty() || std::memcmp(pa.data(), pb.data(), pa.size() * sizeof(FlightState)) == 0);
+}
+
+static TrajectoryOptimizer quietOptimizer() {
+    TrajectoryOptimizer optimizer;
+    optimizer.setVerbose(false);
+    return optimizer;
+}
+
+// ---------- SimulationCache ----------
+
+static void testCacheHitAndMiss() {
+    SimulationCache cache((workDir / "cache").string(), true);
+    TrajectoryOptimizer optimizer = quietOptimizer();
+    optimizer.setCache(&cache);
+
+    AircraftModel aircraft;
+    FlightPath first = optimizer.computeOptimalPath(aircraft, 120.0);
+    CHECK(cache.misses() == 1 && cache.hits() == 0);
+    double thrustAfterMiss = aircraft.thrust;
+    double massAfterMiss = aircraft.massCurrent;
+
+    // Та же модель после расчета: ключ не зависит от тяги в конце полета
+    FlightPath second = optimizer.computeOptimalPath(aircraft, 120.0);
+    CHECK(cache.misses() == 1 && cache.hits() == 1);
+    CHECK(samePath(first, second));
+    CHECK(aircraft.thrust == thrustAfterMiss);
+    CHECK(aircraft.massCurrent == massAfterMiss);
+
+    // Без кэша повторный расчет на той же модели дает ту же траекторию
+    TrajectoryOptimizer plain = quietOptimizer();
+    AircraftModel reused;
+    FlightPath once = plain.computeOptimalPath(reused, 120.0);
+    FlightPath twice = plain.computeOptimalPath(reused, 120.0);
+    CHECK(samePath(once, twice));
+    CHECK(samePath(once, first));
+
+    SimulationSummary summary = optimizer.computeSummary(reused, 120.0);
+    CHECK(cache.hits() == 2);
+    CHECK(summary.pointCount == first.getAllPoints().size());
+    CHECK(reused.thrust == thrustAfterMiss);
+
+    // Другие входные данные - промах
+    AircraftModel heavier(MASS_BASELINE + 1000.0);
+    optimizer.computeOptimalPath(heavier, 120.0);
+    AircraftModel thirsty;
+    thirsty.fuelBurnRate = 3.0;
+    optimizer.computeOptimalPath(thirsty, 120.0);
+    optimizer.computeOptimalPath(aircraft, 90.0);
+    CHECK(cache.misses() == 4 && cache.hits() == 2);
+}
+
+// ---------- Досчет с контрольных точек ----------
+
+static void testResimulateMatchesFullRun() {
+    ControlLawParams baseLaw;
+    // Скорость 147 м/с впервые достигается ближе к концу полета
+    ControlLawParams newLaw = baseLaw;
+    newLaw.speedFraction = 147.0 / VEL_TARGET_MS;
+
+    AircraftModel reference;
+    TrajectoryOptimizer full = quietOptimizer();
+    full.setControlLaw(newLaw);
+    FlightPath expected = full.computeOptimalPath(reference, 300.0);
+
+    // Без кэша: досчет с контрольной точки перед сменой закона
+    TrajectoryOptimizer optimizer = quietOptimizer();
+    optimizer.setCheckpointInterval(10.0);
+    AircraftModel aircraft;
+    FlightPath base = optimizer.computeOptimalPath(aircraft, 300.0);
+    std::vector<SimulationCheckpoint> baseCheckpoints = optimizer.lastCheckpoints();
+    CHECK(baseCheckpoints.size() > 2);
+    CHECK(!samePath(base, expected));
+    optimizer.setControlLaw(newLaw);
+    FlightPath resumed = optimizer.resimulate(aircraft, base, baseCheckpoints, baseLaw, 300.0);
+    CHECK(samePath(resumed, expected));
+    CHECK(aircraft.thrust == reference.thrust);
+
+    // Теплый кэш: перед попаданием считалась другая модель,
+    // ее контрольные точки не должны попасть в досчет
+    SimulationCache cache((workDir / "cache").string(), true);
+    TrajectoryOptimizer warm = quietOptimizer();
+    warm.setCheckpointInterval(10.0);
+    warm.setCache(&cache);
+    AircraftModel cached;
+    warm.computeOptimalPath(cached, 300.0);
+    AircraftModel heavier(MASS_BASELINE + 5000.0);
+    warm.computeOptimalPath(heavier, 300.0);
+    CHECK(!warm.lastCheckpoints().empty());
+
+    FlightPath hit = warm.computeOptimalPath(cached, 300.0);
+    CHECK(cache.hits() == 1);
+    CHECK(samePath(hit, base));
+    CHECK(warm.lastCheckpoints().empty());
+    warm.setControlLaw(newLaw);
+    FlightPath fromHit = warm.resimulate(cached, hit, warm.lastCheckpoints(), baseLaw, 300.0);
+    CHECK(samePath(fromHit, expected));
+
+    // Контрольные точки, сохраненные до попадания, по-прежнему годятся
+    FlightPath fromSaved = warm.resimulate(cached, base, baseCheckpoints, baseLaw, 300.0);
+    CHECK(samePath(fromSaved, expected));
+}
+
+// ---------- WindField ----------
+
+// Трилинейная функция с целыми значениями в узлах: во float узлы хранятся
+// точно, интерполяция должна совпасть с ней в любой точке
+static WindSample windFormula(double x, double h, double t) {
+    WindSample w;
+    w.windX = x * (h / 50.0);
+    w.windV = t - x;
+    w.tempDev = h / 50.0 - t / 10.0;
+    return w;
+}
+
+static bool nearSample(const WindSample& a, const WindSample& b) {
+    return std::fabs(a.windX - b.windX) < 1e-9 && std::fabs(a.windV - b.windV) < 1e-9 &&
+        std::fabs(a.tempDev - b.tempDev) < 1e-9;
+}
+
+static void testWindFieldSampling() {
+    // 6 x 5 x 5 узлов: неполные блоки 4x4x4 по каждой оси
+    WindField field(0.0, 2.0, 6, 100.0, 50.0, 5, 0.0, 10.0, 5);
+    field.fill(windFormula);
+
+    WindField::Cursor cursor;
+    for (int k = 0; k < 5; ++k)
+        for (int j = 0; j < 5; ++j)
+            for (int i = 0; i < 6; ++i) {
+                double x = i * 2.0, h = 100.0 + j * 50.0, t = k * 10.0;
+                CHECK(nearSample(field.sample(x, h, t, cursor), windFormula(x, h, t)));
+            }
+    for (int k = 0; k < 4; ++k)
+        for (int j = 0; j < 4; ++j)
+            for (int i = 0; i < 5; ++i) {
+                double x = i * 2.0 + 1.0, h = 125.0 + j * 50.0, t = k * 10.0 + 5.0;
+                CHECK(nearSample(field.sample(x, h, t, cursor), windFormula(x, h, t)));
+            }
+
+    // Курсор переходит между ячейками и возвращается: результат как у нового
+    WindField::Cursor walker;
+    double path[][3] = { { 0.5, 110, 1 }, { 1.5, 140, 9 }, { 2.5, 160, 12 },
+        { 9.9, 299, 39 }, { 0.5, 110, 1 }, { 5.0, 200, 20 }, { 5.1, 201, 21 } };
+    for (const auto& p : path) {
+        WindField::Cursor fresh;
+        WindSample a = field.sample(p[0], p[1], p[2], walker);
+        WindSample b = field.sample(p[0], p[1], p[2], fresh);
+        CHECK(std::memcmp(&a, &b, sizeof(a)) == 0);
+        CHECK(nearSample(a, windFormula(p[0], p[1], p[2])));
+        CHECK(walker.i == fresh.i && walker.j == fresh.j && walker.k == fresh.k);
+    }
+    field.sample(0.5, 110, 1, walker);
+    CHECK(walker.i == 0 && walker.j == 0 && walker.k == 0);
+    field.sample(1.5, 140, 9, walker);
+    CHECK(walker.i == 0 && walker.j == 0 && walker.k == 0);
+    field.sample(2.5, 140, 9, walker);
+    CHECK(walker.i == 1);
+
+    // За границами и NaN - значение на краю сетки
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    CHECK(nearSample(field.sample(-50.0, 150.0, 10.0, cursor), windFormula(0.0, 150.0, 10.0)));
+    CHECK(nearSample(field.sample(1e9, 150.0, 10.0, cursor), windFormula(10.0, 150.0, 10.0)));
+    CHECK(nearSample(field.sample(4.0, -1e6, 1e6, cursor), windFormula(4.0, 100.0, 40.0)));
+    CHECK(nearSample(field.sample(nan, 300.0, nan, cursor), windFormula(0.0, 300.0, 0.0)));
+    CHECK(nearSample(field.sample(10.0, 300.0, 40.0, cursor), windFormula(10.0, 300.0, 40.0)));
+    CHECK(cursor.i == 4 && cursor.j == 3 && cursor.k == 3);
+
+    bool rejected = false;
+    try { WindField bad(0.0, 1.0, 1, 0.0, 1.0, 2, 0.0, 1.0, 2); }
+    catch (const std::invalid_argument&) { rejected = true; }
+    CHECK(rejected);
+}
+
+// ---------- LatencyHistogram и RealTimePacer ----------
+
+static void testLatencyHistogramPercentiles() {
+    LatencyHistogram empty;
+    CHECK(empty.percentile(99.9) == 0 && empty.count() == 0);
+
+    // До 256 нс значения хранятся точно
+    LatencyHistogram exact;
+    for (uint64_t v = 1; v <= 200; ++v) exact.record(v);
+    CHECK(exact.percentile(50) == 100);
+    CHECK(exact.percentile(99.9) == 200);
+    CHECK(exact.percentile(100) == 200 && exact.max() == 200);
+
+    // Широкий диапазон: оценка не меньше точного значения и выше него
+    // не более чем на ширину интервала (1/128)
+    std::vector<uint64_t> values;
+    uint64_t v = 12345;
+    for (int i = 0; i < 100000; ++i) {
+        v = v * 6364136223846793005ULL + 1442695040888963407ULL;
+        values.push_back(300 + (v >> 40) % 50000000);
+    }
+    LatencyHistogram wide;
+    for (uint64_t x : values) wide.record(x);
+    std::vector<uint64_t> sorted = values;
+    std::sort(sorted.begin(), sorted.end());
+    double percentiles[] = { 50, 90, 99, 99.9, 99.99 };
+    for (double p : percentiles) {
+        uint64_t rank = static_cast<uint64_t>(std::ceil(p * sorted.size() / 100.0 - 1e-6));
+        uint64_t truth = sorted[rank - 1];
+        uint64_t estimate = wide.percentile(p);
+        CHECK(estimate >= truth);
+        CHECK(estimate <= truth + truth / 128);
+    }
+    CHECK(wide.percentile(100) == sorted.back() && wide.max() == sorted.back());
+    CHECK(wide.count() == values.size());
+
+    // Редкий выброс попадает в p99.9, но не в p99
+    LatencyHistogram tail;
+    for (int i = 0; i < 9990; ++i) tail.record(1000);
+    for (int i = 0; i < 10; ++i) tail.record(5000000);
+    CHECK(tail.percentile(99) <= 1000 + 1000 / 128);
+    CHECK(tail.percentile(99.9) <= 1000 + 1000 / 128);
+    CHECK(tail.percentile(99.95) >= 5000000);
+}
+
+static void testRealTimePacerDeadlines() {
+    using namespace std::chrono;
+    RealTimePacer pacer;
+    pacer.start(0.05, 1.0);
+    CHECK(std::fabs(pacer.budgetUs() - 50000.0) < 1.0);
+    auto begin = steady_clock::now();
+    for (int i = 0; i < 4; ++i) {
+        pacer.beginStep();
+        pacer.endStep();
+    }
+    CHECK(pacer.misses() == 0);
+    CHECK(steady_clock::now() - begin >= milliseconds(195));
+
+    // Медленный шаг 120 мс при бюджете 50 мс: дедлайны 100 и 150 мс
+    // пропущены, с шага на 200 мс темп восстанавливается без сдвига сетки
+    pacer.start(0.1, 2.0);
+    for (int i = 0; i < 6; ++i) {
+        pacer.beginStep();
+        if (i == 1) std::this_thread::sleep_for(milliseconds(120));
+        pacer.endStep();
+    }
+    CHECK(pacer.misses() == 2);
+    CHECK(pacer.histogram().count() == 6);
+    CHECK(pacer.histogram().max() >= 120000000);
+    CHECK(pacer.histogram().percentile(50) < 20000000);
+
+    // Новый запуск сбрасывает статистику
+    pacer.start(0.05, 1.0);
+    CHECK(pacer.misses() == 0 && pacer.histogram().count() == 0);
+}
+
+// ---------- SimulationService ----------
+
+static JsonLine reply(SimulationService& service, const std::string& request) {
+    JsonLine parsed;
+    std::string error;
+    CHECK(parsed.parse(service.handle(request), error));
+    return parsed;
+}
+
+static double field(const JsonLine& line, const char* key) {
+    const JsonLine::Value* v = line.find(key);
+    return v ? v->number : std::numeric_limits<double>::quiet_NaN();
+}
+
+static void testServiceThrottle() {
+    SimulationService service(1);
+    JsonLine full = reply(service, "{\"id\": 1, \"maxTime\": 120}");
+    JsonLine half = reply(service, "{\"id\": 2, \"maxTime\": 120, \"throttle\": 0.5}");
+    CHECK(field(full, "ok") == 1 && field(half, "ok") == 1);
+    CHECK(field(half, "id") == 2);
+    CHECK(field(half, "distance") != field(full, "distance"));
+
+    // РУД действует на всем полете, а не только на первом шаге
+    TrajectoryOptimizer optimizer = quietOptimizer();
+    AircraftModel throttled;
+    throttled.throttle = 0.5;
+    SimulationSummary direct = optimizer.computeSummary(throttled, 120.0);
+    CHECK(std::fabs(direct.finalState.x - field(half, "distance")) < 1e-3);
+    CHECK(direct.finalThrust == throttled.thrust);
+    CHECK(std::fabs(throttled.thrust - 0.5 * THRUST_TOTAL * direct.finalState.massCurr / MASS_BASELINE) < 1e-6);
+
+    // Тяга пересчитывается на каждом шаге - задавать ее напрямую нельзя
+    JsonLine thrust = reply(service, "{\"id\": 3, \"thrust\": 20000}");
+    CHECK(field(thrust, "ok") == 0);
+    JsonLine steps = reply(service, "{\"maxTime\": 1e9}");
+    CHECK(field(steps, "ok") == 0);
+}
+
+#ifndef _WIN32
+static int connectTo(const std::string& path) {
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+    for (int attempt = 0; attempt < 200; ++attempt) {
+        int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0) return fd;
+        ::close(fd);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return -1;
+}
+
+// Строки ответа до count штук или до закрытия соединения
+static std::vector<std::string> readLines(int fd, size_t count) {
+    std::vector<std::string> lines;
+    std::string pending;
+    char buf[4096];
+    while (lines.size() < count) {
+        ssize_t n = ::recv(fd, buf, sizeof(buf), 0);
+        if (n <= 0) break;
+        pending.append(buf, static_cast<size_t>(n));
+        size_t newline;
+        while ((newline = pending.find('\n')) != std::string::npos) {
+            lines.push_back(pending.substr(0, newline));
+            pending.erase(0, newline + 1);
+        }
+    }
+    return lines;
+}
+
+static void testServiceSocket() {
+    std::string path = (workDir / "service.sock").string();
+    std::cout.flush();
+    pid_t child = ::fork();
+    if (child == 0) {
+        std::cout.setstate(std::ios::badbit);
+        try { SimulationService(2).serveSocket(path); }
+        catch (...) {}
+        std::_Exit(1);
+    }
+
+    // Клиентов больше, чем потоков пула: все обслуживаются одним циклом poll
+    std::vector<int> fds;
+    for (int c = 0; c < 8; ++c) fds.push_back(connectTo(path));
+    CHECK(std::find(fds.begin(), fds.end(), -1) == fds.end());
+    if (std::find(fds.begin(), fds.end(), -1) == fds.end()) {
+        for (int c = 0; c < 8; ++c) {
+            std::string request = "{\"id\": " + std::to_string(c) + ", \"cmd\": \"ping\"}\n" +
+                "{\"id\": " + std::to_string(100 + c) + ", \"maxTime\": 30}\r\n";
+            // Запрос приходит двумя кусками с разрывом внутри строки
+            ::send(fds[c], request.data(), 10, MSG_NOSIGNAL);
+            ::send(fds[c], request.data() + 10, request.size() - 10, MSG_NOSIGNAL);
+        }
+        for (int c = 0; c < 8; ++c) {
+            std::vector<std::string> lines = readLines(fds[c], 2);
+            CHECK(lines.size() == 2);
+            std::vector<double> ids;
+            for (const auto& line : lines) {
+                JsonLine parsed;
+                std::string error;
+                CHECK(parsed.parse(line, error));
+                CHECK(field(parsed, "ok") == 1);
+                ids.push_back(field(parsed, "id"));
+            }
+            std::sort(ids.begin(), ids.end());
+            CHECK(ids == std::vector<double>({ double(c), double(100 + c) }));
+        }
+
+        // Закрытые соединения убираются из опроса, новые принимаются
+        for (int fd : fds) ::close(fd);
+        int late = connectTo(path);
+        std::string stats = "{\"id\": 7, \"cmd\": \"stats\"}\n";
+        ::send(late, stats.data(), stats.size(), MSG_NOSIGNAL);
+        std::vector<std::string> lines = readLines(late, 1);
+        CHECK(lines.size() == 1 && lines[0].find("\"served\":17,\"failed\":0") != std::string::npos);
+        ::close(late);
+    }
+
+    ::kill(child, SIGTERM);
+    int status = 0;
+    ::waitpid(child, &status, 0);
+}
+#else
+static void testServiceSocket() {}
+#endif
+
+static void run(const char* name, void (*test)()) {
+    static int counter = 0;
+    std::filesystem::path dir = workDir / ("case_" + std::to_string(++counter));
+    std::filesystem::create_directories(dir);
+    std::filesystem::current_path(dir);
+    int before = failures;
+    test();
+    std::cout << (failures == before ? "[ OK ] " : "[FAIL] ") << name << "\n";
+}
+
+int main() {
+    auto stamp = std::chrono::steady_clock::now().time_since_epoch().count();
+    workDir = std::filesystem::temp_directory_path() / ("super_mega_tests_" + std::to_string(stamp));
+    std::filesystem::create_directories(workDir);
+
+    run("SimulationCache: попадание, промах, состояние модели", testCacheHitAndMiss);
+    run("TrajectoryOptimizer: досчет после смены закона равен полному расчету", testResimulateMatchesFullRun);
+    run("WindField: узлы, середины ячеек, курсор и края сетки", testWindFieldSampling);
+    run("LatencyHistogram: точные и оценочные перцентили, p99.9", testLatencyHistogramPercentiles);
+    run("RealTimePacer: дедлайны и медленный шаг", testRealTimePacerDeadlines);
+    run("SimulationService: положение РУД, отклоненные параметры", testServiceThrottle);
+    run("SimulationService: несколько клиентов сокета в одном цикле poll", testServiceSocket);
+
+    std::error_code ec;
+    std::filesystem::current_path(workDir.parent_path(), ec);
+    std::filesystem::remove_all(workDir, ec);
+    std::cout << (failures ? "Есть ошибки: " + std::to_string(failures) : std::string("Все проверки пройдены")) << "\n";
+    return failures ? 1 : 0;
+}
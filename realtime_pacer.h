@@ -0,0 +1,139 @@
+// Режим реального времени: гистограмма задержек шага и тактирование
+// по сетке дедлайнов. Общий для Super_mega_dz.cpp и DZ2/task_11.2.cpp.
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+// Гистограмма в стиле HDR: значения до 2^SUB_BITS хранятся точно, выше -
+// по 2^(SUB_BITS-1) линейных интервалов на каждую степень двойки
+// (относительная погрешность не более 0.8%)
+class LatencyHistogram {
+    static const int SUB_BITS = 8;
+    static const uint64_t SUB_COUNT = 1ULL << SUB_BITS;
+    static const uint64_t HALF_COUNT = SUB_COUNT / 2;
+
+    std::vector<uint64_t> counts;
+    uint64_t total = 0;
+    uint64_t maxValue = 0;
+    double sum = 0;
+
+    static int highestBit(uint64_t v) {
+        int bit = 0;
+        while (v >>= 1) ++bit;
+        return bit;
+    }
+
+    static size_t bucketIndex(uint64_t v) {
+        if (v < SUB_COUNT) return static_cast<size_t>(v);
+        int msb = highestBit(v);
+        int shift = msb - SUB_BITS + 1;
+        uint64_t mantissa = v >> shift;            // [HALF_COUNT, SUB_COUNT)
+        return static_cast<size_t>(SUB_COUNT + (msb - SUB_BITS) * HALF_COUNT +
+            (mantissa - HALF_COUNT));
+    }
+
+    // Наибольшее значение, попадающее в интервал index
+    static uint64_t bucketUpperBound(size_t index) {
+        if (index < SUB_COUNT) return index;
+        size_t group = (index - SUB_COUNT) / HALF_COUNT;
+        uint64_t mantissa = HALF_COUNT + (index - SUB_COUNT) % HALF_COUNT;
+        int shift = static_cast<int>(group) + 1;
+        return ((mantissa + 1) << shift) - 1;
+    }
+
+public:
+    LatencyHistogram() : counts(SUB_COUNT + (64 - SUB_BITS) * HALF_COUNT, 0) {}
+
+    void record(uint64_t valueNs) {
+        ++counts[bucketIndex(valueNs)];
+        ++total;
+        sum += static_cast<double>(valueNs);
+        maxValue = std::max(maxValue, valueNs);
+    }
+
+    void reset() {
+        std::fill(counts.begin(), counts.end(), 0);
+        total = 0;
+        maxValue = 0;
+        sum = 0;
+    }
+
+    uint64_t count() const { return total; }
+    uint64_t max() const { return maxValue; }
+    double mean() const { return total ? sum / total : 0.0; }
+
+    // percentile в процентах, например 99.9
+    uint64_t percentile(double percentile) const {
+        if (total == 0) return 0;
+        // Допуск: 99.9 / 100 * 10000 дает 9990.000000000002, а не ранг 9990
+        uint64_t rank = static_cast<uint64_t>(std::ceil(percentile / 100.0 * total - 1e-6));
+        rank = std::max<uint64_t>(1, std::min(rank, total));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < counts.size(); ++i) {
+            seen += counts[i];
+            if (seen >= rank) return std::min(bucketUpperBound(i), maxValue);
+        }
+        return maxValue;
+    }
+};
+
+// Шаг модели dt занимает dt / rate секунд реального времени.
+// Дедлайны идут по фиксированной сетке от старта, без догоняющих сдвигов.
+class RealTimePacer {
+    using Clock = std::chrono::steady_clock;
+
+    Clock::duration stepBudget{};
+    Clock::time_point deadline;
+    Clock::time_point stepStart;
+    LatencyHistogram latency;
+    uint64_t deadlineMisses = 0;
+
+public:
+    void start(double timeStep, double rate) {
+        stepBudget = std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(timeStep / rate));
+        latency.reset();
+        deadlineMisses = 0;
+        deadline = Clock::now();
+        stepStart = deadline;
+    }
+
+    void beginStep() { stepStart = Clock::now(); }
+
+    // Фиксирует время расчета шага и ждет его дедлайна
+    void endStep() {
+        Clock::time_point done = Clock::now();
+        latency.record(static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(done - stepStart).count()));
+        deadline += stepBudget;
+        if (done > deadline) {
+            ++deadlineMisses;
+        }
+        else {
+            std::this_thread::sleep_until(deadline);
+        }
+    }
+
+    const LatencyHistogram& histogram() const { return latency; }
+    uint64_t misses() const { return deadlineMisses; }
+    double budgetUs() const {
+        return std::chrono::duration<double, std::micro>(stepBudget).count();
+    }
+
+    void printReport() const {
+        std::cout << "\n=== РЕЖИМ РЕАЛЬНОГО ВРЕМЕНИ ===\n";
+        std::cout << "Бюджет шага: " << budgetUs() << " мкс | шагов: " << latency.count()
+            << " | пропущено дедлайнов: " << deadlineMisses << "\n";
+        std::cout << "Задержка расчета шага, мкс: среднее " << latency.mean() / 1000.0
+            << " | p50 " << latency.percentile(50) / 1000.0
+            << " | p99 " << latency.percentile(99) / 1000.0
+            << " | p99.9 " << latency.percentile(99.9) / 1000.0
+            << " | max " << latency.max() / 1000.0 << "\n";
+    }
+};